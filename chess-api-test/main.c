@@ -0,0 +1,72 @@
+/*
+ * Checks the C interface of chessbotshared the way a host uses it, through
+ * the header alone and from C. Run by ctest when the shared library is built.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ChessBotApi.h"
+
+static int failures = 0;
+
+static void expect(const int condition, const char *what) {
+    if (!condition) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static int move(ChessBotEngine *engine, const char *fen, char *uci) {
+    return chessbot_move(engine, fen, 20, uci, 6, NULL);
+}
+
+int main(void) {
+    /* positions no game reaches, which the search must never see */
+    const char *rejected[] = {
+        "4k3/8/8/8/8/8/4R3/4K3 w - - 0 1", /* the side that just moved is in check */
+        "4k2P/8/8/8/8/8/8/4K3 w - - 0 1", /* a pawn on the last rank */
+        "4k3/8/8/8/8/8/8/p3K3 b - - 0 1", /* a pawn on the first rank */
+        "4k3/8/8/8/8/8/8/8 w - - 0 1", /* no white king */
+        "4k3/8/8/8/8/8/8/3K3R w K - 0 1", /* castling with the king off its square */
+        "4k3/8/8/8/4n3/8/3P4/4K3 w - e3 0 1", /* en passant without a pawn that just moved */
+        "not a fen",
+    };
+    char uci[6];
+    ChessBotStats stats;
+    size_t i;
+
+    ChessBotEngine *engine = chessbot_create();
+    expect(engine != NULL, "chessbot_create returns an engine");
+    if (!engine)
+        return 1;
+    expect(chessbot_api_version() == CHESSBOT_API_VERSION, "the library matches the header");
+
+    expect(chessbot_move(engine, "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 20, uci, sizeof uci,
+                         &stats) == CHESSBOT_OK && strlen(uci) == 4 && stats.depth > 0,
+           "a move from the starting position");
+    expect(move(engine, "4k3/8/8/8/8/8/4R3/4K3 b - - 0 1", uci) == CHESSBOT_OK, "a move out of check");
+    expect(move(engine, "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", uci) == CHESSBOT_NO_MOVE, "no move in stalemate");
+    expect(move(engine, "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 2", uci) == CHESSBOT_OK, "a move after a double step");
+
+    for (i = 0; i < sizeof rejected / sizeof rejected[0]; i++) {
+        char what[96];
+        snprintf(what, sizeof what, "rejects %s", rejected[i]);
+        expect(move(engine, rejected[i], uci) == CHESSBOT_INVALID_ARGUMENT, what);
+    }
+
+    expect(chessbot_set_option(engine, "threads", "2") == CHESSBOT_OK, "two threads");
+    expect(chessbot_set_option(engine, "threads", "0") == CHESSBOT_INVALID_ARGUMENT, "rejects zero threads");
+    expect(chessbot_set_option(engine, "colour", "white") == CHESSBOT_INVALID_ARGUMENT, "rejects unknown options");
+    expect(move(engine, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -", uci) == CHESSBOT_OK,
+           "a move without the move counters");
+    expect(chessbot_set_option(engine, "threads", "9999") == CHESSBOT_OK &&
+           move(engine, "4k3/8/8/8/8/8/4R3/4K3 b - - 0 1", uci) == CHESSBOT_OK, "more threads than cores");
+    expect(chessbot_set_option(engine, "hash", "1") == CHESSBOT_OK, "a smaller table");
+    chessbot_new_game(engine);
+    expect(move(engine, "4k3/8/8/8/8/8/4R3/4K3 b - - 0 1", uci) == CHESSBOT_OK, "a move in a new game");
+
+    chessbot_destroy(engine);
+    if (!failures)
+        printf("all C interface checks passed\n");
+    return failures ? 1 : 0;
+}
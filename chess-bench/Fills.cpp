@@ -0,0 +1,163 @@
+#include "Fills.h"
+
+#include "Sliders.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(CHESS_COMPETITION_X86_64)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// the vector kernel is compiled for AVX2 on its own, the rest of the engine stays portable
+#if defined(CHESS_COMPETITION_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_COMPETITION_AVX2 __attribute__((target("avx2")))
+#else
+#define CHESS_COMPETITION_AVX2
+#endif
+
+namespace {
+    constexpr Bitboard NotFileA = ~FileABitboard;
+    constexpr Bitboard NotFileH = ~FileHBitboard;
+
+    // north, east, north-east and north-west grow the square index by these, their opposites shrink it
+    constexpr int Shifts[4] = {8, 1, 9, 7};
+    // squares a step may land on without wrapping around the board edge
+    constexpr Bitboard UpMasks[4] = {~0ULL, NotFileA, NotFileA, NotFileH};
+    constexpr Bitboard DownMasks[4] = {~0ULL, NotFileH, NotFileH, NotFileA};
+
+    // doubling the step each round floods up to seven squares in three rounds
+    Bitboard fillUp(Bitboard generators, Bitboard propagators, const int shift) {
+        generators |= propagators & (generators << shift);
+        propagators &= propagators << shift;
+        generators |= propagators & (generators << 2 * shift);
+        propagators &= propagators << 2 * shift;
+        generators |= propagators & (generators << 4 * shift);
+        return generators;
+    }
+
+    Bitboard fillDown(Bitboard generators, Bitboard propagators, const int shift) {
+        generators |= propagators & (generators >> shift);
+        propagators &= propagators >> shift;
+        generators |= propagators & (generators >> 2 * shift);
+        propagators &= propagators >> 2 * shift;
+        generators |= propagators & (generators >> 4 * shift);
+        return generators;
+    }
+
+#ifdef CHESS_COMPETITION_X86_64
+    // lane i holds direction i of Shifts: rook-like sliders in the first two lanes, bishop-like in the last two
+    CHESS_COMPETITION_AVX2 Fills::SliderAttacks sliderAttacksAvx2(const Bitboard orthogonal, const Bitboard diagonal,
+                                                                  const Bitboard occupancy) {
+        const __m256i shift1 = _mm256_setr_epi64x(8, 1, 9, 7);
+        const __m256i shift2 = _mm256_setr_epi64x(16, 2, 18, 14);
+        const __m256i shift4 = _mm256_setr_epi64x(32, 4, 36, 28);
+        const __m256i upMask = _mm256_setr_epi64x(~0LL, static_cast<long long>(NotFileA),
+                                                  static_cast<long long>(NotFileA), static_cast<long long>(NotFileH));
+        const __m256i downMask = _mm256_setr_epi64x(~0LL, static_cast<long long>(NotFileH),
+                                                    static_cast<long long>(NotFileH), static_cast<long long>(NotFileA));
+        const __m256i empty = _mm256_set1_epi64x(static_cast<long long>(~occupancy));
+        const __m256i sliders = _mm256_setr_epi64x(static_cast<long long>(orthogonal), static_cast<long long>(orthogonal),
+                                                   static_cast<long long>(diagonal), static_cast<long long>(diagonal));
+
+        __m256i up = sliders;
+        __m256i upPropagators = _mm256_and_si256(empty, upMask);
+        __m256i down = sliders;
+        __m256i downPropagators = _mm256_and_si256(empty, downMask);
+
+        up = _mm256_or_si256(up, _mm256_and_si256(upPropagators, _mm256_sllv_epi64(up, shift1)));
+        upPropagators = _mm256_and_si256(upPropagators, _mm256_sllv_epi64(upPropagators, shift1));
+        down = _mm256_or_si256(down, _mm256_and_si256(downPropagators, _mm256_srlv_epi64(down, shift1)));
+        downPropagators = _mm256_and_si256(downPropagators, _mm256_srlv_epi64(downPropagators, shift1));
+
+        up = _mm256_or_si256(up, _mm256_and_si256(upPropagators, _mm256_sllv_epi64(up, shift2)));
+        upPropagators = _mm256_and_si256(upPropagators, _mm256_sllv_epi64(upPropagators, shift2));
+        down = _mm256_or_si256(down, _mm256_and_si256(downPropagators, _mm256_srlv_epi64(down, shift2)));
+        downPropagators = _mm256_and_si256(downPropagators, _mm256_srlv_epi64(downPropagators, shift2));
+
+        up = _mm256_or_si256(up, _mm256_and_si256(upPropagators, _mm256_sllv_epi64(up, shift4)));
+        down = _mm256_or_si256(down, _mm256_and_si256(downPropagators, _mm256_srlv_epi64(down, shift4)));
+
+        // one more step from the filled squares reaches the blockers
+        const __m256i attacks = _mm256_or_si256(_mm256_and_si256(_mm256_sllv_epi64(up, shift1), upMask),
+                                                _mm256_and_si256(_mm256_srlv_epi64(down, shift1), downMask));
+
+        const __m128i low = _mm256_castsi256_si128(attacks);
+        const __m128i high = _mm256_extracti128_si256(attacks, 1);
+        return {
+            static_cast<Bitboard>(_mm_cvtsi128_si64(low) | _mm_extract_epi64(low, 1)),
+            static_cast<Bitboard>(_mm_cvtsi128_si64(high) | _mm_extract_epi64(high, 1))
+        };
+    }
+
+    void cpuid(const unsigned leaf, unsigned (&registers)[4]) {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), 0);
+        for (int i = 0; i < 4; i++)
+            registers[i] = static_cast<unsigned>(values[i]);
+#else
+        __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // the YMM registers are only usable when the operating system saves them on a context switch
+    bool osSavesYmm() {
+#if defined(_MSC_VER)
+        return (_xgetbv(0) & 6) == 6;
+#else
+        unsigned low, high;
+        asm("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (low & 6) == 6;
+#endif
+    }
+#endif
+
+    const bool UseAvx2 = Fills::hasAvx2();
+}
+
+bool Fills::hasAvx2() {
+#ifdef CHESS_COMPETITION_X86_64
+    unsigned registers[4];
+    cpuid(0, registers);
+    if (registers[0] < 7)
+        return false;
+    cpuid(1, registers);
+    const bool osxsave = registers[2] & (1u << 27);
+    if (!osxsave || !osSavesYmm())
+        return false;
+    cpuid(7, registers);
+    return registers[1] & (1u << 5);
+#else
+    return false;
+#endif
+}
+
+bool Fills::usesAvx2() {
+    return UseAvx2;
+}
+
+Fills::SliderAttacks Fills::sliderAttacksScalar(const Bitboard orthogonal, const Bitboard diagonal,
+                                                const Bitboard occupancy) {
+    const Bitboard empty = ~occupancy;
+    SliderAttacks attacks{0, 0};
+    for (int direction = 0; direction < 4; direction++) {
+        const Bitboard sliders = direction < 2 ? orthogonal : diagonal;
+        const int shift = Shifts[direction];
+        const Bitboard up = fillUp(sliders, empty & UpMasks[direction], shift);
+        const Bitboard down = fillDown(sliders, empty & DownMasks[direction], shift);
+        const Bitboard hit = ((up << shift) & UpMasks[direction]) | ((down >> shift) & DownMasks[direction]);
+        (direction < 2 ? attacks.orthogonal : attacks.diagonal) |= hit;
+    }
+    return attacks;
+}
+
+Fills::SliderAttacks Fills::sliderAttacks(const Bitboard orthogonal, const Bitboard diagonal,
+                                          const Bitboard occupancy) {
+#ifdef CHESS_COMPETITION_X86_64
+    if (UseAvx2)
+        return sliderAttacksAvx2(orthogonal, diagonal, occupancy);
+#endif
+    return sliderAttacksScalar(orthogonal, diagonal, occupancy);
+}
@@ -0,0 +1,38 @@
+#ifndef CHESS_COMPETITION_FILLS_H
+#define CHESS_COMPETITION_FILLS_H
+
+#include "Bitboard.h"
+
+// Kogge-Stone occluded fills: the squares attacked by a whole set of sliders,
+// computed in a few shifts per direction however many pieces the set holds.
+// They give the union of the attacks, not what each piece attacks, so they
+// suit questions like "which squares does that side hit" rather than mobility
+// counts. With AVX2 the eight directions run as two vectors of four lanes,
+// otherwise one direction at a time. The kernel is picked once at startup.
+namespace Fills {
+    struct SliderAttacks {
+        // squares attacked along ranks and files, and along diagonals
+        Bitboard orthogonal;
+        Bitboard diagonal;
+    };
+
+    /**
+     * @brief Every square attacked by a set of rook-like and a set of bishop-like sliders
+     *
+     * A queen belongs in both sets. Blocked squares are attacked, the squares behind them are not.
+     *
+     * @return SliderAttacks The attacks of each set, the sliders' own squares only if another slider hits them
+     */
+    SliderAttacks sliderAttacks(Bitboard orthogonal, Bitboard diagonal, Bitboard occupancy);
+
+    // the portable kernel, for comparing against the vector one
+    SliderAttacks sliderAttacksScalar(Bitboard orthogonal, Bitboard diagonal, Bitboard occupancy);
+
+    // true when the CPU and the operating system support AVX2
+    bool hasAvx2();
+
+    // whether sliderAttacks runs the AVX2 kernel
+    bool usesAvx2();
+} // namespace Fills
+
+#endif //CHESS_COMPETITION_FILLS_H
@@ -0,0 +1,781 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "Board.h"
+#include "Fills.h"
+#include "Mcts.h"
+#include "PackedPosition.h"
+#include "Search.h"
+#include "Sliders.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+// Fixed, varied suite: openings, middlegames, endgames, mates and stalemates.
+// Changing it changes the signature, so only ever append to it together with a note.
+const char *BenchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+    "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+    "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+    "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+    "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+    "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+    "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+    "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+    "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1",
+    "7k/7P/6K1/8/3B4/8/8/8 b - - 0 1",
+    "2r3k1/1q1nbppp/r3p3/3pP3/pPpP4/P1Q2N2/2RN1PPP/2R4K b - - 0 1",
+};
+
+struct PositionResult {
+    std::string fen;
+    std::string bestMove;
+    int score = 0;
+    uint64_t nodes = 0;
+    double milliseconds = 0;
+};
+
+struct SuiteResult {
+    std::vector<PositionResult> positions;
+    uint64_t nodes = 0;
+    double milliseconds = 0;
+
+    double nps() const { return milliseconds > 0 ? nodes * 1000.0 / milliseconds : 0; }
+};
+
+struct ProbeResult {
+    size_t megabytes = 0;
+    bool hugePages = false;
+    double plainNanoseconds = 0;
+    double prefetchedNanoseconds = 0;
+};
+
+struct FillsResult {
+    int sets = 0;
+    // per set of one side's sliders
+    double lookupNanoseconds = 0;
+    double scalarNanoseconds = 0;
+    double avx2Nanoseconds = 0;
+    bool avx2 = false;
+    bool matches = true;
+};
+
+struct PackedResult {
+    int positions = 0;
+    // per position
+    double fenNanoseconds = 0;
+    double packNanoseconds = 0;
+    double unpackNanoseconds = 0;
+    bool matches = true;
+};
+
+struct StartupResult {
+    int searches = 0;
+    int threads = 0;
+    bool pinned = false;
+    // per search or start, in microseconds
+    double searchMean = 0;
+    double searchP99 = 0;
+    // the same with a new Search each time, its table allocated and cleared
+    double newSearchMean = 0;
+    double newSearchP99 = 0;
+    double poolMean = 0;
+    double poolP99 = 0;
+    double spawnMean = 0;
+    double spawnP99 = 0;
+};
+
+struct ColdStartResult {
+    int runs = 0;
+    // medians over the runs, in microseconds
+    double loadMicroseconds = 0; // from launching the process to main, static initialisation included
+    double firstMoveMicroseconds = 0; // from main to the first move found
+    double totalMicroseconds = 0;
+};
+
+struct MctsResult {
+
+    uint64_t playouts = 0;
+    double milliseconds = 0;
+    // positions where MCTS picks the same move as alpha-beta
+    int agreements = 0;
+
+    double playoutsPerSecond() const { return milliseconds > 0 ? playouts * 1000.0 / milliseconds : 0; }
+};
+
+SuiteResult runSuite(const int depth, const size_t hashMegabytes) {
+    SuiteResult suite;
+    SearchLimits limits;
+    limits.maxDepth = depth;
+
+    for (const char *fen: BenchPositions) {
+        Board board(fen);
+        // a fresh search per position keeps every result independent of the order
+        Search search(hashMegabytes);
+
+        const auto start = std::chrono::steady_clock::now();
+        const Move best = search.findBestMove(board, limits);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        suite.positions.push_back({fen, best.toUci(), search.getScore(), search.getNodes(), elapsed.count()});
+        suite.nodes += search.getNodes();
+        suite.milliseconds += elapsed.count();
+    }
+
+    return suite;
+}
+
+// The same suite under Monte Carlo tree search with a fixed number of playouts
+// per position, compared against the alpha-beta moves
+MctsResult runMcts(const SuiteResult &suite, const uint64_t playouts, const int threads) {
+    MctsResult result;
+    MctsLimits limits;
+    limits.moveTime = std::chrono::milliseconds::max();
+    limits.maxPlayouts = playouts;
+    limits.threads = threads;
+
+    Mcts mcts;
+    for (const auto &position: suite.positions) {
+        Board board(position.fen);
+        const auto start = std::chrono::steady_clock::now();
+        const Move best = mcts.findBestMove(board, limits);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        result.playouts += mcts.getPlayouts();
+        result.milliseconds += elapsed.count();
+        result.agreements += best.toUci() == position.bestMove;
+    }
+    return result;
+}
+
+// Searches the suite and counts the heap allocations made after the first
+// iteration of every search, which must be none. Needs CHESS_COUNT_ALLOCATIONS.
+int checkAllocations(const int depth, const size_t hashMegabytes) {
+    if (!AllocationCounter::Enabled) {
+        std::cout << "allocation counting needs a build with CHESS_COUNT_ALLOCATIONS" << std::endl;
+        return 1;
+    }
+
+    SearchLimits limits;
+    limits.maxDepth = depth;
+
+    uint64_t total = 0, nodes = 0;
+    for (const char *fen: BenchPositions) {
+        Board board(fen);
+        Search search(hashMegabytes);
+        uint64_t afterFirstIteration = AllocationCounter::count();
+        search.setInfoCallback([&afterFirstIteration](const SearchInfo &info) {
+            if (info.depth == 1)
+                afterFirstIteration = AllocationCounter::count();
+        });
+
+        search.findBestMove(board, limits);
+        const uint64_t allocations = AllocationCounter::count() - afterFirstIteration;
+        if (allocations)
+            std::cout << allocations << " allocations searching " << fen << "\n";
+        total += allocations;
+        nodes += search.getNodes();
+    }
+
+    std::cout << "Nodes searched  : " << nodes << "\n";
+    std::cout << "Allocations     : " << total << std::endl;
+    return total == 0 ? 0 : 1;
+}
+
+// Chains of dependent probes into a table far bigger than the caches, the way a search
+// walks it, once as they come and once with the next bucket prefetched while the
+// current one is probed, the way make-move overlaps them.
+ProbeResult measureProbeLatency(const size_t megabytes) {
+    constexpr size_t ProbeCount = 1 << 22;
+
+    TranspositionTable table(megabytes);
+    std::mt19937_64 random(20240601);
+    std::vector<uint64_t> keys(ProbeCount);
+    for (auto &key: keys)
+        key = random();
+    for (size_t i = 0; i < keys.size(); i += 2)
+        table.store(keys[i], Move(), 0, 0, Bound::EXACT);
+
+    TTEntry entry{};
+    // every stored depth is zero, but the compiler cannot know the next probe does not depend on it
+    uint64_t chain = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const uint64_t key: keys)
+        chain = table.probe(key ^ chain, entry) ? entry.depth : 0;
+    const std::chrono::duration<double, std::nano> plain = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (i + 1 < keys.size())
+            table.prefetch(keys[i + 1]);
+        chain = table.probe(keys[i] ^ chain, entry) ? entry.depth : 0;
+    }
+    const std::chrono::duration<double, std::nano> prefetched = std::chrono::steady_clock::now() - start;
+
+    return {table.megabytes(), table.hugePages(), plain.count() / ProbeCount, prefetched.count() / ProbeCount};
+}
+
+// All slider attacks of one side, once looked up piece by piece and once
+// flooded at once with Kogge-Stone fills, over every side of the bench positions.
+FillsResult measureFills() {
+    constexpr int Rounds = 20000;
+
+    struct Input {
+        Bitboard orthogonal, diagonal, occupancy, expected;
+    };
+    std::vector<Input> inputs;
+    for (const char *fen: BenchPositions) {
+        const Board board(fen);
+        const Position &position = board.getPosition();
+        for (const PieceColor color: {PieceColor::WHITE, PieceColor::BLACK}) {
+            Input input{};
+            input.orthogonal = position.orthogonals & position.pieces(color);
+            input.diagonal = position.diagonals & position.pieces(color);
+            input.occupancy = position.occupied() ^ position.pieces(!color, PieceType::KING);
+            inputs.push_back(input);
+        }
+    }
+
+    FillsResult result;
+    result.sets = static_cast<int>(inputs.size());
+    result.avx2 = Fills::hasAvx2();
+    const double total = static_cast<double>(Rounds) * inputs.size();
+
+    // the inputs change a little every round so no call can be hoisted out of the loop
+    Bitboard sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; round++) {
+        for (Input &input: inputs) {
+            Bitboard attacks = 0;
+            Bitboard pieces = input.orthogonal;
+            while (pieces)
+                attacks |= Attacks::rook(popLsb(pieces), input.occupancy ^ (sink & 1));
+            pieces = input.diagonal;
+            while (pieces)
+                attacks |= Attacks::bishop(popLsb(pieces), input.occupancy ^ (sink & 1));
+            input.expected = attacks;
+            sink += attacks;
+        }
+    }
+    result.lookupNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / total;
+
+    for (const bool avx2: {false, true}) {
+        if (avx2 && !result.avx2)
+            continue;
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < Rounds; round++) {
+            for (const Input &input: inputs) {
+                const Fills::SliderAttacks attacks = avx2
+                    ? Fills::sliderAttacks(input.orthogonal, input.diagonal, input.occupancy ^ (sink & 1))
+                    : Fills::sliderAttacksScalar(input.orthogonal, input.diagonal, input.occupancy ^ (sink & 1));
+                result.matches = result.matches && (attacks.orthogonal | attacks.diagonal) == input.expected;
+                sink += attacks.orthogonal | attacks.diagonal;
+            }
+        }
+        const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / total;
+        (avx2 ? result.avx2Nanoseconds : result.scalarNanoseconds) = nanoseconds;
+    }
+
+    // keeps the work observable
+    if (sink == 42)
+        std::cout << "";
+    return result;
+}
+
+// Positions decoded from FEN against the same positions decoded from the packed
+// format, over the bench positions and random games played out from them. Every
+// position must survive packing, a trip through a packed file and unpacking unchanged.
+PackedResult measurePacked() {
+    constexpr int Rounds = 200;
+    constexpr int PliesPerGame = 40;
+
+    std::vector<Position> positions;
+    std::mt19937 random(20250318);
+    for (const char *fen: BenchPositions) {
+        Board board(fen);
+        for (int ply = 0; ply < PliesPerGame; ply++) {
+            positions.push_back(board.getPosition());
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (moves.size == 0)
+                break;
+            board.makeMove(moves.moves[random() % moves.size]);
+        }
+    }
+
+    PackedResult result;
+    result.positions = static_cast<int>(positions.size());
+
+    std::vector<PackedRecord> records(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        records[i] = {PackedPosition::pack(positions[i]), 0, 1, 0, static_cast<uint32_t>(i)};
+        const Position unpacked = records[i].position.unpack();
+        result.matches = result.matches && !std::memcmp(&unpacked, &positions[i], sizeof(Position));
+    }
+
+    const std::string path = "chessbench-packed.tmp";
+    PackedWriter writer;
+    PackedFile file;
+    result.matches = result.matches && writer.open(path, false) && writer.write(records.data(), records.size());
+    writer.close();
+    result.matches = result.matches && file.open(path) && file.size() == records.size() &&
+                     !std::memcmp(file.begin(), records.data(), records.size() * sizeof(PackedRecord));
+    file.close();
+    std::remove(path.c_str());
+
+    // only the bench positions have a FEN to parse
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; round++) {
+        for (const char *fen: BenchPositions)
+            sink += Board(fen).getPosition().key;
+    }
+    result.fenNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                            (static_cast<double>(Rounds) * std::size(BenchPositions));
+
+    const double total = static_cast<double>(Rounds) * positions.size();
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; round++) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            records[i].position = PackedPosition::pack(positions[i]);
+            sink += records[i].position.occupancy;
+        }
+    }
+    result.packNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / total;
+
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < Rounds; round++) {
+        for (const PackedRecord &record: records)
+            sink += record.position.unpack().key;
+    }
+    result.unpackNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / total;
+
+    // keeps the work observable
+    if (sink == 42)
+        std::cout << "";
+    return result;
+}
+
+// Latency of starting a search: whole depth-1 searches on the given threads, on a
+// Search kept between them and on a new one each time, which pays for its table,
+// and bare starts of that many helpers, waking parked pool workers against
+// creating and joining threads as every search used to.
+StartupResult measureStartup(const int searches, const int threads) {
+    StartupResult result;
+    result.searches = searches;
+    result.threads = threads;
+    result.pinned = ThreadPool::shared().isPinned();
+
+    const auto summarize = [](std::vector<double> &samples, double &mean, double &p99) {
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (const double sample: samples)
+            total += sample;
+        mean = total / static_cast<double>(samples.size());
+        p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    };
+    const auto microseconds = [](const std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    Search search(1);
+    const Board board;
+    SearchLimits limits;
+    limits.maxDepth = 1;
+    limits.threads = threads;
+    std::vector<double> samples;
+    for (int i = 0; i < searches; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        search.findBestMove(board, limits);
+        samples.push_back(microseconds(start));
+    }
+    summarize(samples, result.searchMean, result.searchP99);
+
+    samples.clear();
+    for (int i = 0; i < searches; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        Search fresh;
+        fresh.findBestMove(board, limits);
+        samples.push_back(microseconds(start));
+    }
+    summarize(samples, result.newSearchMean, result.newSearchP99);
+
+    std::atomic<int> sink{0};
+    samples.clear();
+    for (int i = 0; i < searches; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        ThreadPool::Batch helpers(ThreadPool::shared());
+        for (int t = 1; t < threads; t++)
+            helpers.submit([&sink] { sink++; });
+        helpers.wait();
+        samples.push_back(microseconds(start));
+    }
+    summarize(samples, result.poolMean, result.poolP99);
+
+    samples.clear();
+    for (int i = 0; i < searches; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> helpers;
+        for (int t = 1; t < threads; t++)
+            helpers.emplace_back([&sink] { sink++; });
+        for (auto &helper: helpers)
+            helper.join();
+        samples.push_back(microseconds(start));
+    }
+    summarize(samples, result.spawnMean, result.spawnP99);
+    return result;
+}
+
+// Run as a fresh process by measureColdStart: the first move from main, as the
+// simulator makes it, with both times on the steady clock, which the parent shares.
+int runColdStartChild(const std::chrono::steady_clock::time_point mainEntered) {
+    Search search;
+    SearchLimits limits;
+    limits.maxDepth = 1;
+    const Move move = search.findBestMove(Board(), limits);
+    const auto moveFound = std::chrono::steady_clock::now();
+
+    const auto nanoseconds = [](const std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    };
+    std::cout << nanoseconds(mainEntered) << " " << nanoseconds(moveFound) << " " << move.toUci() << std::endl;
+    return 0;
+}
+
+// Cost of the first move of a new process, which a tournament pays for every game:
+// the bench launches itself that many times and reads when each child reached
+// main and when it had its move.
+ColdStartResult measureColdStart(const int runs, const char *program) {
+    ColdStartResult result;
+    const std::string command = "\"" + std::string(program) + "\" --cold-start-child";
+    std::vector<double> load, firstMove, total;
+    for (int i = 0; i < runs; i++) {
+        const auto launched = std::chrono::steady_clock::now();
+#ifdef _WIN32
+        FILE *child = _popen(command.c_str(), "r");
+#else
+        FILE *child = popen(command.c_str(), "r");
+#endif
+        if (!child)
+            break;
+        long long mainEntered = 0, moveFound = 0;
+        const bool parsed = std::fscanf(child, "%lld %lld", &mainEntered, &moveFound) == 2;
+#ifdef _WIN32
+        _pclose(child);
+#else
+        pclose(child);
+#endif
+        if (!parsed)
+            break;
+
+        const double start = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(launched.time_since_epoch()).count());
+        load.push_back((mainEntered - start) / 1000.0);
+        firstMove.push_back((moveFound - mainEntered) / 1000.0);
+        total.push_back((moveFound - start) / 1000.0);
+    }
+
+    result.runs = static_cast<int>(total.size());
+    if (result.runs == 0)
+        return result;
+    const auto median = [](std::vector<double> &samples) {
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    };
+    result.loadMicroseconds = median(load);
+    result.firstMoveMicroseconds = median(firstMove);
+    result.totalMicroseconds = median(total);
+    return result;
+}
+
+void writeJson(const std::string &path, const int depth, const SuiteResult &suite, const int threads,
+               const double scalingNps, const double efficiency, const ProbeResult &probe, const MctsResult &mcts, const FillsResult &fills,
+               const PackedResult &packed, const StartupResult &startup, const ColdStartResult &coldStart) {
+    std::ofstream out(path);
+    out << "{\n";
+    out << "  \"depth\": " << depth << ",\n";
+    out << "  \"signature\": " << suite.nodes << ",\n";
+    out << "  \"time_ms\": " << static_cast<uint64_t>(suite.milliseconds) << ",\n";
+    out << "  \"nps\": " << static_cast<uint64_t>(suite.nps()) << ",\n";
+    out << "  \"sliders\": \"" << Sliders::backendName(Sliders::backend()) << "\",\n";
+    if (threads > 1) {
+        out << "  \"threads\": " << threads << ",\n";
+        out << "  \"threads_nps\": " << static_cast<uint64_t>(scalingNps) << ",\n";
+        out << "  \"scaling_efficiency\": " << efficiency << ",\n";
+    }
+    if (probe.megabytes > 0) {
+        out << "  \"probe_table_mb\": " << probe.megabytes << ",\n";
+        out << "  \"probe_huge_pages\": " << (probe.hugePages ? "true" : "false") << ",\n";
+        out << "  \"probe_ns\": " << probe.plainNanoseconds << ",\n";
+        out << "  \"probe_prefetched_ns\": " << probe.prefetchedNanoseconds << ",\n";
+    }
+    if (fills.sets > 0) {
+        out << "  \"fills_lookup_ns\": " << fills.lookupNanoseconds << ",\n";
+        out << "  \"fills_scalar_ns\": " << fills.scalarNanoseconds << ",\n";
+        if (fills.avx2)
+            out << "  \"fills_avx2_ns\": " << fills.avx2Nanoseconds << ",\n";
+        out << "  \"fills_match\": " << (fills.matches ? "true" : "false") << ",\n";
+    }
+    if (packed.positions > 0) {
+        out << "  \"packed_fen_ns\": " << packed.fenNanoseconds << ",\n";
+        out << "  \"packed_pack_ns\": " << packed.packNanoseconds << ",\n";
+        out << "  \"packed_unpack_ns\": " << packed.unpackNanoseconds << ",\n";
+        out << "  \"packed_match\": " << (packed.matches ? "true" : "false") << ",\n";
+    }
+    if (startup.searches > 0) {
+        out << "  \"startup_threads\": " << startup.threads << ",\n";
+        out << "  \"startup_pinned\": " << (startup.pinned ? "true" : "false") << ",\n";
+        out << "  \"startup_search_us\": " << startup.searchMean << ",\n";
+        out << "  \"startup_search_p99_us\": " << startup.searchP99 << ",\n";
+        out << "  \"startup_new_search_us\": " << startup.newSearchMean << ",\n";
+        out << "  \"startup_new_search_p99_us\": " << startup.newSearchP99 << ",\n";
+        out << "  \"startup_pool_us\": " << startup.poolMean << ",\n";
+        out << "  \"startup_pool_p99_us\": " << startup.poolP99 << ",\n";
+        out << "  \"startup_spawn_us\": " << startup.spawnMean << ",\n";
+        out << "  \"startup_spawn_p99_us\": " << startup.spawnP99 << ",\n";
+    }
+    if (coldStart.runs > 0) {
+        out << "  \"cold_start_runs\": " << coldStart.runs << ",\n";
+        out << "  \"cold_start_load_us\": " << coldStart.loadMicroseconds << ",\n";
+        out << "  \"cold_start_first_move_us\": " << coldStart.firstMoveMicroseconds << ",\n";
+        out << "  \"cold_start_total_us\": " << coldStart.totalMicroseconds << ",\n";
+    }
+    if (mcts.playouts > 0) {
+        out << "  \"mcts_playouts\": " << mcts.playouts << ",\n";
+        out << "  \"mcts_playouts_per_second\": " << static_cast<uint64_t>(mcts.playoutsPerSecond()) << ",\n";
+        out << "  \"mcts_agreements\": " << mcts.agreements << ",\n";
+    }
+    out << "  \"positions\": [\n";
+    for (size_t i = 0; i < suite.positions.size(); i++) {
+        const auto &position = suite.positions[i];
+        out << "    {\"fen\": \"" << position.fen << "\", \"bestmove\": \"" << position.bestMove
+            << "\", \"score\": " << position.score << ", \"nodes\": " << position.nodes
+            << ", \"time_ms\": " << position.milliseconds << "}"
+            << (i + 1 < suite.positions.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main(int argc, char *argv[]) {
+    // before anything else, this is the moment the child of a cold start measurement reports
+    const auto mainEntered = std::chrono::steady_clock::now();
+    if (argc == 2 && !std::strcmp(argv[1], "--cold-start-child"))
+        return runColdStartChild(mainEntered);
+
+    int depth = 5;
+    int threads = 1;
+    size_t hashMegabytes = TranspositionTable::DefaultMegabytes;
+    size_t probeMegabytes = 0;
+    bool allocations = false;
+    bool fills = false;
+    bool packed = false;
+    uint64_t mctsPlayouts = 0;
+    int startupSearches = 0;
+    int coldStartRuns = 0;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--depth") && i + 1 < argc) {
+            depth = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+            hashMegabytes = std::stoul(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--probe") && i + 1 < argc) {
+            probeMegabytes = std::stoul(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--mcts") && i + 1 < argc) {
+            mctsPlayouts = std::stoull(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--startup") && i + 1 < argc) {
+            startupSearches = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--cold-start") && i + 1 < argc) {
+            coldStartRuns = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--fills")) {
+            fills = true;
+        } else if (!std::strcmp(argv[i], "--packed")) {
+            packed = true;
+        } else if (!std::strcmp(argv[i], "--allocations")) {
+            allocations = true;
+        } else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--sliders") && i + 1 < argc) {
+            const char *name = argv[++i];
+            const Sliders::Backend backend = !std::strcmp(name, "pext") ? Sliders::Backend::PEXT : Sliders::Backend::MAGIC;
+            if (std::strcmp(name, Sliders::backendName(backend)) || !Sliders::select(backend)) {
+                std::cout << "slider backend " << name << " is not available" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "usage: chessbench [--depth D] [--threads N] [--hash MB] [--probe MB] [--json FILE] "
+                         "[--sliders magic|pext] [--mcts PLAYOUTS] [--startup SEARCHES] [--cold-start RUNS] [--fills] [--packed] [--allocations]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (allocations)
+        return checkAllocations(depth, hashMegabytes);
+
+    // the signature run is always single threaded so it is deterministic
+    const SuiteResult suite = runSuite(depth, hashMegabytes);
+    for (size_t i = 0; i < suite.positions.size(); i++) {
+        const auto &position = suite.positions[i];
+        std::cout << "position " << (i + 1) << "/" << suite.positions.size() << " bestmove " << position.bestMove
+                  << " score " << position.score << " nodes " << position.nodes << std::endl;
+    }
+
+    std::cout << "\n";
+    std::cout << "Total time (ms) : " << static_cast<uint64_t>(suite.milliseconds) << "\n";
+    std::cout << "Nodes searched  : " << suite.nodes << "\n";
+    std::cout << "Nodes/second    : " << static_cast<uint64_t>(suite.nps()) << "\n";
+    std::cout << "Slider attacks  : " << Sliders::backendName(Sliders::backend()) << std::endl;
+
+    // run the suite on every thread at once to see how well throughput scales
+    double scalingNps = 0;
+    double efficiency = 0;
+    if (threads > 1) {
+        std::vector<uint64_t> nodes(threads);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back([&, t] { nodes[t] = runSuite(depth, hashMegabytes).nodes; });
+        for (auto &worker: workers)
+            worker.join();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        uint64_t totalNodes = 0;
+        for (const uint64_t count: nodes)
+            totalNodes += count;
+        scalingNps = totalNodes * 1000.0 / elapsed.count();
+        efficiency = scalingNps / (threads * suite.nps());
+
+        std::cout << "\n";
+        std::cout << "Threads         : " << threads << "\n";
+        std::cout << "Nodes/second    : " << static_cast<uint64_t>(scalingNps) << "\n";
+        std::cout << "Efficiency      : " << static_cast<int>(efficiency * 100) << "%" << std::endl;
+    }
+
+    // the other search paradigm on the same positions and threads
+    MctsResult mcts;
+    if (mctsPlayouts > 0) {
+        mcts = runMcts(suite, mctsPlayouts, threads);
+        std::cout << "\n";
+        std::cout << "MCTS playouts   : " << mcts.playouts << "\n";
+        std::cout << "Playouts/second : " << static_cast<uint64_t>(mcts.playoutsPerSecond()) << "\n";
+        std::cout << "Same move       : " << mcts.agreements << "/" << suite.positions.size() << std::endl;
+    }
+
+    // memory latency of hash probes, which bounds the node rate long before the CPU does
+    ProbeResult probe;
+    if (probeMegabytes > 0) {
+        probe = measureProbeLatency(probeMegabytes);
+        std::cout << "\n";
+        std::cout << "Hash table (MB) : " << probe.megabytes << (probe.hugePages ? " (huge pages)" : "") << "\n";
+        std::cout << "Probe (ns)      : " << probe.plainNanoseconds << "\n";
+        std::cout << "Prefetched (ns) : " << probe.prefetchedNanoseconds << std::endl;
+    }
+
+    // bulk slider attacks against per piece lookups, checking that both agree
+    FillsResult fillsResult;
+    if (fills) {
+        fillsResult = measureFills();
+        std::cout << "\n";
+        std::cout << "Lookups (ns)    : " << fillsResult.lookupNanoseconds << "\n";
+        std::cout << "Fills (ns)      : " << fillsResult.scalarNanoseconds << "\n";
+        if (fillsResult.avx2)
+            std::cout << "AVX2 fills (ns) : " << fillsResult.avx2Nanoseconds << "\n";
+        std::cout << "Fills match     : " << (fillsResult.matches ? "yes" : "NO") << std::endl;
+    }
+
+    // decoding datasets: text FEN against the packed binary format
+    PackedResult packedResult;
+    if (packed) {
+        packedResult = measurePacked();
+        std::cout << "\n";
+        std::cout << "Positions       : " << packedResult.positions << "\n";
+        std::cout << "FEN (ns)        : " << packedResult.fenNanoseconds << "\n";
+        std::cout << "Pack (ns)       : " << packedResult.packNanoseconds << "\n";
+        std::cout << "Unpack (ns)     : " << packedResult.unpackNanoseconds << "\n";
+        std::cout << "Packed match    : " << (packedResult.matches ? "yes" : "NO") << std::endl;
+    }
+
+    // how long a search takes to get going, on the persistent pool against fresh threads
+    StartupResult startup;
+    if (startupSearches > 0) {
+        startup = measureStartup(startupSearches, std::max(threads, 2));
+        std::cout << "\n";
+        std::cout << "Start threads   : " << startup.threads << (startup.pinned ? " (pinned)" : "") << "\n";
+        std::cout << "Depth 1 (us)    : " << startup.searchMean << " p99 " << startup.searchP99 << "\n";
+        std::cout << "New search (us) : " << startup.newSearchMean << " p99 " << startup.newSearchP99 << "\n";
+        std::cout << "Pool start (us) : " << startup.poolMean << " p99 " << startup.poolP99 << "\n";
+        std::cout << "Spawn (us)      : " << startup.spawnMean << " p99 " << startup.spawnP99 << std::endl;
+    }
+
+    // a new process up to its first move, tables and all
+    ColdStartResult coldStart;
+    if (coldStartRuns > 0) {
+        coldStart = measureColdStart(coldStartRuns, argv[0]);
+        std::cout << "\n";
+        if (coldStart.runs == 0) {
+            std::cout << "Cold start      : could not run " << argv[0] << std::endl;
+        } else {
+            std::cout << "Cold starts     : " << coldStart.runs << "\n";
+            std::cout << "Load (us)       : " << coldStart.loadMicroseconds << "\n";
+            std::cout << "First move (us) : " << coldStart.firstMoveMicroseconds << "\n";
+            std::cout << "Total (us)      : " << coldStart.totalMicroseconds << std::endl;
+        }
+    }
+
+    if (!jsonPath.empty())
+        writeJson(jsonPath, depth, suite, threads, scalingNps, efficiency, probe, mcts, fillsResult, packedResult,
+                  startup, coldStart);
+}
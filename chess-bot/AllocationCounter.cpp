@@ -0,0 +1,69 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> Allocations{0};
+}
+
+uint64_t AllocationCounter::count() {
+    return Allocations.load(std::memory_order_relaxed);
+}
+
+#ifdef CHESS_COMPETITION_COUNT_ALLOCATIONS
+namespace {
+    void *allocate(const std::size_t size) noexcept {
+        Allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+}
+
+// Every form that pairs with the replaced deletes is replaced too, a sanitizer's
+// allocator would otherwise see memory it never handed out come back to it.
+// The aligned forms are left alone on both sides.
+void *operator new(const std::size_t size) {
+    if (void *memory = allocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](const std::size_t size) {
+    if (void *memory = allocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+#endif
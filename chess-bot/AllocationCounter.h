@@ -0,0 +1,22 @@
+#ifndef CHESS_COMPETITION_ALLOCATION_COUNTER_H
+#define CHESS_COMPETITION_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new, to keep the
+// search path allocation free. Only built with the CHESS_COUNT_ALLOCATIONS
+// CMake option, every other build, the shipped library included, keeps the
+// standard allocator untouched and always reports zero.
+namespace AllocationCounter {
+    constexpr bool Enabled =
+#ifdef CHESS_COMPETITION_COUNT_ALLOCATIONS
+        true;
+#else
+        false;
+#endif
+
+    // allocations made by all threads since the program started
+    uint64_t count();
+} // namespace AllocationCounter
+
+#endif //CHESS_COMPETITION_ALLOCATION_COUNTER_H
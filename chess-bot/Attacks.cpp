@@ -0,0 +1,160 @@
+#include "Attacks.h"
+
+#include <algorithm>
+
+#include "Position.h"
+
+namespace {
+    // exchange values, the king is worth more than anything it could win
+    constexpr int SeeValues[7] = {0, 100, 320, 330, 500, 900, 20000};
+
+    // how much each piece type hitting the king zone adds to the attack weight
+    constexpr int KingAttackWeights[7] = {0, 0, 2, 2, 3, 5, 0};
+
+    constexpr int index(const PieceColor color) { return static_cast<int>(color); }
+
+    Bitboard pawnAttacks(const Bitboard pawns, const PieceColor color) {
+        if (color == PieceColor::WHITE)
+            return ((pawns << 7) & ~FileHBitboard) | ((pawns << 9) & ~FileABitboard);
+        return ((pawns >> 9) & ~FileHBitboard) | ((pawns >> 7) & ~FileABitboard);
+    }
+}
+
+Bitboard Attacks::attackersTo(const Position &position, const int square, const Bitboard occupancy) {
+    return (Pawn[index(PieceColor::BLACK)][square] & position.pieces(PieceColor::WHITE, PieceType::PAWN))
+           | (Pawn[index(PieceColor::WHITE)][square] & position.pieces(PieceColor::BLACK, PieceType::PAWN))
+           | (Knight[square] & position.knights)
+           | (King[square] & position.kings())
+           | (bishop(square, occupancy) & position.diagonals)
+           | (rook(square, occupancy) & position.orthogonals);
+}
+
+int Attacks::see(const Position &position, const Move move) {
+    const int from = move.from(), to = move.to();
+    const Piece mover = position.pieceOn(from);
+    Piece target = position.pieceOn(to);
+
+    // en passant captures land on an empty square
+    if (target.isEmpty() && mover.type == PieceType::PAWN && fileOf(from) != fileOf(to))
+        target = Piece(PieceType::PAWN, !mover.color);
+
+    int gain[32];
+    int depth = 0;
+    gain[0] = SeeValues[static_cast<int>(target.type)];
+
+    Bitboard occupancy = position.occupied() ^ squareBit(from);
+    Bitboard attackers = attackersTo(position, to, occupancy) & occupancy;
+    int attackerValue = SeeValues[static_cast<int>(move.promotion() != PieceType::EMPTY ? move.promotion() : mover.type)];
+    PieceColor side = !mover.color;
+
+    while (depth < 31) {
+        depth++;
+        // speculative score if the piece standing on the target square gets taken
+        gain[depth] = attackerValue - gain[depth - 1];
+        if (std::max(-gain[depth - 1], gain[depth]) < 0)
+            break;
+
+        const Bitboard ours = attackers & position.pieces(side);
+        if (!ours)
+            break;
+
+        // recapture with the least valuable piece
+        PieceType type = PieceType::PAWN;
+        Bitboard candidates = 0;
+        for (const PieceType next: {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP,
+                                    PieceType::ROOK, PieceType::QUEEN, PieceType::KING}) {
+            candidates = ours & position.pieces(next);
+            if (candidates) {
+                type = next;
+                break;
+            }
+        }
+
+        occupancy ^= squareBit(lsb(candidates));
+        // sliders lined up behind the piece that just moved join in
+        attackers |= (bishop(to, occupancy) & position.diagonals) | (rook(to, occupancy) & position.orthogonals);
+        attackers &= occupancy;
+        attackerValue = SeeValues[static_cast<int>(type)];
+        side = !side;
+    }
+
+    while (--depth)
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    return gain[0];
+}
+
+int Attacks::see(const Position &position, const Move move, const AttackInfo &info) {
+    // knights and kings never uncover an x-ray onto their own target, so an
+    // undefended target square is simply won
+    const Piece mover = position.pieceOn(move.from());
+    if ((mover.type == PieceType::KNIGHT || mover.type == PieceType::KING) &&
+        !(info.attacked[index(!mover.color)] & squareBit(move.to())))
+        return SeeValues[static_cast<int>(position.pieceOn(move.to()).type)];
+
+    return see(position, move);
+}
+
+void AttackInfo::compute(const Position &position) {
+    const Bitboard occupancy = position.occupied();
+    *this = AttackInfo{};
+
+    for (const PieceColor color: {PieceColor::BLACK, PieceColor::WHITE}) {
+        const int king = position.kingSquare(color);
+        kingZone[index(color)] = Attacks::King[king] | squareBit(king);
+        attackedBy[index(color)][static_cast<int>(PieceType::PAWN)] =
+                pawnAttacks(position.pieces(color, PieceType::PAWN), color);
+    }
+
+    for (const PieceColor color: {PieceColor::BLACK, PieceColor::WHITE}) {
+        const int us = index(color), them = index(!color);
+        // let sliders see through the enemy king
+        const Bitboard sliderOccupancy = occupancy ^ position.pieces(!color, PieceType::KING);
+
+        // squares not blocked by our own pieces and not covered by enemy pawns
+        const Bitboard mobilityArea = ~position.pieces(color) & ~attackedBy[them][static_cast<int>(PieceType::PAWN)];
+
+        auto record = [&](const PieceType type, const Bitboard attacks) {
+            attackedBy[us][static_cast<int>(type)] |= attacks;
+            mobility[us][static_cast<int>(type)] += popCount(attacks & mobilityArea);
+            if (attacks & kingZone[them]) {
+                kingAttackers[them]++;
+                kingAttackWeight[them] += KingAttackWeights[static_cast<int>(type)];
+            }
+        };
+
+        Bitboard pieces = position.pieces(color, PieceType::KNIGHT);
+        while (pieces)
+            record(PieceType::KNIGHT, Attacks::Knight[popLsb(pieces)]);
+
+        pieces = position.pieces(color, PieceType::BISHOP);
+        while (pieces)
+            record(PieceType::BISHOP, Attacks::bishop(popLsb(pieces), sliderOccupancy));
+
+        pieces = position.pieces(color, PieceType::ROOK);
+        while (pieces)
+            record(PieceType::ROOK, Attacks::rook(popLsb(pieces), sliderOccupancy));
+
+        pieces = position.pieces(color, PieceType::QUEEN);
+        while (pieces)
+            record(PieceType::QUEEN, Attacks::queen(popLsb(pieces), sliderOccupancy));
+
+        attackedBy[us][static_cast<int>(PieceType::KING)] = Attacks::King[position.kingSquare(color)];
+
+        for (const Bitboard attacks: attackedBy[us])
+            attacked[us] |= attacks;
+    }
+
+    const PieceColor us = position.sideToMove;
+    const int king = position.kingSquare(us);
+    checkers = Attacks::attackersTo(position, king, occupancy) & position.pieces(!us);
+
+    // enemy sliders that would hit our king if exactly one of our pieces moved away
+    const Bitboard them = position.pieces(!us);
+    Bitboard snipers = ((Attacks::bishop(king, 0) & position.diagonals) |
+                        (Attacks::rook(king, 0) & position.orthogonals)) & them;
+    while (snipers) {
+        const Bitboard blockers = Attacks::Between[king][popLsb(snipers)] & occupancy;
+        if (popCount(blockers) == 1 && (blockers & position.pieces(us)))
+            pinned |= blockers;
+    }
+}
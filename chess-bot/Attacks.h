@@ -0,0 +1,169 @@
+#ifndef CHESS_COMPETITION_ATTACKS_H
+#define CHESS_COMPETITION_ATTACKS_H
+
+#include <array>
+#include <cstdint>
+
+#include "Bitboard.h"
+#include "Move.h"
+#include "Piece.h"
+#include "Sliders.h"
+
+struct Position;
+struct AttackInfo;
+
+namespace Attacks {
+    namespace detail {
+        constexpr bool onBoard(const int rank, const int file) {
+            return rank >= 0 && rank < 8 && file >= 0 && file < 8;
+        }
+
+        template<size_t N>
+        constexpr std::array<Bitboard, 64> leaperTable(const int (&offsets)[N][2]) {
+            std::array<Bitboard, 64> table{};
+            for (int square = 0; square < 64; square++) {
+                for (const auto &offset: offsets) {
+                    const int rank = rankOf(square) + offset[0], file = fileOf(square) + offset[1];
+                    if (onBoard(rank, file))
+                        table[square] |= squareBit(squareOf(rank, file));
+                }
+            }
+            return table;
+        }
+
+        constexpr int KnightOffsets[8][2] = {
+            {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+            {1, -2}, {1, 2}, {2, -1}, {2, 1}
+        };
+        constexpr int KingOffsets[8][2] = {
+            {-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+            {0, 1}, {1, -1}, {1, 0}, {1, 1}
+        };
+        constexpr int WhitePawnOffsets[2][2] = {{1, -1}, {1, 1}};
+        constexpr int BlackPawnOffsets[2][2] = {{-1, -1}, {-1, 1}};
+    }
+
+    // Ray directions. The first four grow the square index, so the nearest blocker
+    // on them is the lowest set bit, the last four shrink it. Opposite directions are four apart.
+    enum Direction { NORTH, EAST, NORTH_EAST, NORTH_WEST, SOUTH, WEST, SOUTH_WEST, SOUTH_EAST };
+
+    constexpr int DirectionOffsets[8][2] = {
+        {1, 0}, {0, 1}, {1, 1}, {1, -1},
+        {-1, 0}, {0, -1}, {-1, -1}, {-1, 1}
+    };
+
+    constexpr auto Knight = detail::leaperTable(detail::KnightOffsets);
+    constexpr auto King = detail::leaperTable(detail::KingOffsets);
+    // indexed by [PieceColor][square], the squares a pawn of that colour attacks
+    constexpr std::array<std::array<Bitboard, 64>, 2> Pawn = {
+        detail::leaperTable(detail::BlackPawnOffsets), detail::leaperTable(detail::WhitePawnOffsets)
+    };
+
+    // every square in a direction on an empty board
+    constexpr auto Rays = [] {
+        std::array<std::array<Bitboard, 64>, 8> rays{};
+        for (int direction = 0; direction < 8; direction++) {
+            for (int square = 0; square < 64; square++) {
+                int rank = rankOf(square) + DirectionOffsets[direction][0];
+                int file = fileOf(square) + DirectionOffsets[direction][1];
+                for (; detail::onBoard(rank, file); rank += DirectionOffsets[direction][0],
+                                                    file += DirectionOffsets[direction][1])
+                    rays[direction][square] |= squareBit(squareOf(rank, file));
+            }
+        }
+        return rays;
+    }();
+
+    // squares strictly between two squares sharing a line, empty otherwise
+    constexpr auto Between = [] {
+        std::array<std::array<Bitboard, 64>, 64> between{};
+        for (int from = 0; from < 64; from++) {
+            for (int direction = 0; direction < 8; direction++) {
+                Bitboard ray = Rays[direction][from];
+                while (ray) {
+                    const int to = lsb(ray);
+                    ray &= ray - 1;
+                    between[from][to] = Rays[direction][from] & ~Rays[direction][to] & ~squareBit(to);
+                }
+            }
+        }
+        return between;
+    }();
+
+    // the whole line through two squares, both included, empty when they do not share one
+    constexpr auto Line = [] {
+        std::array<std::array<Bitboard, 64>, 64> line{};
+        for (int from = 0; from < 64; from++) {
+            for (int direction = 0; direction < 8; direction++) {
+                const Bitboard full = Rays[direction][from] | Rays[(direction + 4) % 8][from] | squareBit(from);
+                Bitboard ray = Rays[direction][from];
+                while (ray) {
+                    const int to = lsb(ray);
+                    ray &= ray - 1;
+                    line[from][to] = full;
+                }
+            }
+        }
+        return line;
+    }();
+
+    // attacks along one ray stopping at the first blocker, only used to fill the slider tables
+    constexpr Bitboard rayAttacks(const int direction, const int square, const Bitboard occupancy) {
+        const Bitboard ray = Rays[direction][square];
+        const Bitboard blockers = ray & occupancy;
+        if (!blockers)
+            return ray;
+
+        const int blocker = direction < SOUTH ? lsb(blockers) : msb(blockers);
+        return ray ^ Rays[direction][blocker];
+    }
+
+    inline Bitboard bishop(const int square, const Bitboard occupancy) {
+        return Sliders::attacks(Sliders::Bishop[square], occupancy);
+    }
+
+    inline Bitboard rook(const int square, const Bitboard occupancy) {
+        return Sliders::attacks(Sliders::Rook[square], occupancy);
+    }
+
+    inline Bitboard queen(const int square, const Bitboard occupancy) {
+        return bishop(square, occupancy) | rook(square, occupancy);
+    }
+
+    // Pieces of both colours attacking a square with the given occupancy
+    Bitboard attackersTo(const Position &position, int square, Bitboard occupancy);
+
+    /**
+     * @brief Static exchange evaluation, the material balance of the capture sequence on the target square
+     *
+     * @return int Centipawns won by the side playing the move, assuming both sides recapture with their least valuable piece
+     */
+    int see(const Position &position, Move move);
+
+    // Same as above, answering from the node's attack maps when the target cannot be recaptured
+    int see(const Position &position, Move move, const AttackInfo &info);
+} // namespace Attacks
+
+// Everything about which squares are attacked, built once per node and shared by
+// move generation, exchange evaluation and king safety
+struct AttackInfo {
+    // indexed by PieceColor. Slider attacks see through the enemy king, so a
+    // king can never step back along the ray it is checked on.
+    Bitboard attacked[2];
+    Bitboard attackedBy[2][7]; // [PieceColor][PieceType]
+    // the king square and its neighbours
+    Bitboard kingZone[2];
+    // number of enemy pieces hitting the zone and their summed attack weight
+    int kingAttackers[2];
+    int kingAttackWeight[2];
+    // safe squares reachable by each piece type, summed over all pieces of that type
+    int mobility[2][7];
+    // enemy pieces giving check to the side to move
+    Bitboard checkers;
+    // pieces of the side to move that may not leave the line to their king
+    Bitboard pinned;
+
+    void compute(const Position &position);
+};
+
+#endif //CHESS_COMPETITION_ATTACKS_H
@@ -0,0 +1,46 @@
+#ifndef CHESS_COMPETITION_BITBOARD_H
+#define CHESS_COMPETITION_BITBOARD_H
+
+#include <bit>
+#include <cstdint>
+
+// One bit per square, bit 0 is a1 and bit 63 is h8
+using Bitboard = uint64_t;
+
+constexpr Bitboard FileABitboard = 0x0101010101010101ULL;
+constexpr Bitboard FileHBitboard = FileABitboard << 7;
+constexpr Bitboard Rank1Bitboard = 0xFFULL;
+constexpr Bitboard Rank2Bitboard = Rank1Bitboard << 8;
+constexpr Bitboard Rank3Bitboard = Rank1Bitboard << 16;
+constexpr Bitboard Rank6Bitboard = Rank1Bitboard << 40;
+constexpr Bitboard Rank7Bitboard = Rank1Bitboard << 48;
+constexpr Bitboard Rank8Bitboard = Rank1Bitboard << 56;
+
+constexpr Bitboard squareBit(const int square) { return 1ULL << square; }
+
+constexpr int lsb(const Bitboard bitboard) { return std::countr_zero(bitboard); }
+
+constexpr int msb(const Bitboard bitboard) { return 63 - std::countl_zero(bitboard); }
+
+constexpr int popCount(const Bitboard bitboard) { return std::popcount(bitboard); }
+
+// move every square by a square offset, dropping whatever wraps around a board edge
+template<int Offset>
+constexpr Bitboard shift(const Bitboard bitboard) {
+    if constexpr (Offset == 8) return bitboard << 8;
+    else if constexpr (Offset == -8) return bitboard >> 8;
+    else if constexpr (Offset == 7) return (bitboard << 7) & ~FileHBitboard;
+    else if constexpr (Offset == 9) return (bitboard << 9) & ~FileABitboard;
+    else if constexpr (Offset == -7) return (bitboard >> 7) & ~FileABitboard;
+    else if constexpr (Offset == -9) return (bitboard >> 9) & ~FileHBitboard;
+    else static_assert(Offset == 8, "unsupported shift");
+}
+
+// remove and return the lowest set square
+constexpr int popLsb(Bitboard &bitboard) {
+    const int square = lsb(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
+
+#endif //CHESS_COMPETITION_BITBOARD_H
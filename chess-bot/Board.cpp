@@ -4,18 +4,9 @@
 
 #include "Board.h"
 
+#include <algorithm>
 #include <iostream>
 
-std::unordered_map<PieceType, std::function<std::vector<std::string>(Board*, PieceColor, uint8_t, uint8_t)> >
-Board::moveFunctions = {
-    {PieceType::PAWN, Board::pawnMove},
-    {PieceType::KNIGHT, Board::knightMove},
-    {PieceType::BISHOP, Board::bishopMove},
-    {PieceType::ROOK, Board::rookMove},
-    {PieceType::KING, Board::kingMove},
-    {PieceType::QUEEN, Board::queenMove}
-};
-
 Board::Board() {
     setStartingBoard();
 }
@@ -25,9 +16,10 @@ Board::Board(const std::string &fen) {
 
     // get an object representing the board as passed in from fen
     auto fenBoard = fenBoardFromString(fen);
-    mColorTurn = fenBoard.whiteTurn ? PieceColor::WHITE : PieceColor::BLACK;
-    mFullMove = fenBoard.fullMove;
-    mHalfMove = fenBoard.halfMove;
+    mPosition.sideToMove = fenBoard.whiteTurn ? PieceColor::WHITE : PieceColor::BLACK;
+    // past the fifty-move limit every count means the same, clamping keeps it from wrapping
+    mPosition.fullMove = static_cast<uint16_t>(std::clamp(fenBoard.fullMove, 1, UINT16_MAX));
+    mPosition.halfMove = static_cast<uint8_t>(std::clamp(fenBoard.halfMove, 0, UINT8_MAX));
 
     uint8_t rank = 7;
     uint8_t file = 0;
@@ -57,44 +49,69 @@ Board::Board(const std::string &fen) {
             file++;
         }
     }
+
+    uint8_t castling = NO_CASTLING;
+    for (const char c: fenBoard.castling) {
+        if (c == 'K') castling |= WHITE_KINGSIDE;
+        else if (c == 'Q') castling |= WHITE_QUEENSIDE;
+        else if (c == 'k') castling |= BLACK_KINGSIDE;
+        else if (c == 'q') castling |= BLACK_QUEENSIDE;
+    }
+    mPosition.castling = castling;
+
+    // keep the en passant square only when it can be taken, the same way makeMove does
+    int epRank, epFile;
+    if (algebraicToCoords(fenBoard.enPassant, epRank, epFile)) {
+        const PieceColor us = mPosition.sideToMove;
+        const int pawnRank = us == PieceColor::WHITE ? epRank - 1 : epRank + 1;
+        for (int fileOffset: {-1, 1}) {
+            const Piece pawn = getPiece(pawnRank, epFile + fileOffset);
+            if (epFile + fileOffset >= 0 && epFile + fileOffset < 8 &&
+                pawn.type == PieceType::PAWN && pawn.color == us)
+                mPosition.epSquare = squareOf(epRank, epFile);
+        }
+    }
+
+    mPosition.computeKey();
 }
 
 Piece Board::getPiece(const uint8_t rank, const uint8_t file) const {
-    if (rank <= 8 && file <= 8)
-        return mBoard[rank][file];
+    if (rank < 8 && file < 8)
+        return mPosition.pieceOn(squareOf(rank, file));
     return Piece();
 }
 
 void Board::setPiece(const Piece piece, uint8_t rank, uint8_t file) {
-    if (rank <= 8 && file <= 8)
-        mBoard[rank][file] = piece;
+    if (rank < 8 && file < 8)
+        mPosition.put(piece, squareOf(rank, file));
 }
 
 
-std::vector< std::string> Board::getValidMoves(PieceColor color) {
-    std::vector<std::string> validMoves;
-
-    auto getMovesForPiece = [&](const Piece piece, uint8_t rank, uint8_t file) -> std::vector<std::string> {
-        if (piece.isEmpty())
-            return {};
-        return moveFunctions[piece.type](this, piece.color, rank, file);
-    };
-
-    for (int rank = 0; rank < 8; rank++) {
-        for (int file = 0; file < 8; file++) {
-            Piece currentPiece = getPiece(rank, file);
-            if (currentPiece.color != color)
-                continue;
-
-            auto moves = getMovesForPiece(currentPiece, rank, file);
-            // append the moves for the current piece onto the list of all moves
-            validMoves.insert(validMoves.end(), moves.begin(), moves.end());
-        }
+std::vector<std::string> Board::getValidMoves(PieceColor color) {
+    Position position = mPosition;
+    if (position.sideToMove != color) {
+        // hand the turn over, an en passant capture would only have been possible for the other side
+        position.sideToMove = color;
+        position.epSquare = NO_SQUARE;
     }
 
+    AttackInfo info;
+    info.compute(position);
+    MoveList moves;
+    ::generateMoves<GenType::ALL>(position, info, moves);
+
+    std::vector<std::string> validMoves;
+    for (const Move move: moves)
+        validMoves.push_back(move.toUci());
     return validMoves;
 }
 
+void Board::getLegalMoves(MoveList &moves) const {
+    AttackInfo info;
+    info.compute(mPosition);
+    getLegalMoves(moves, info);
+}
+
 void Board::printBoard() const {
     std::cout << "  a b c d e f g h" << std::endl;
     
@@ -102,7 +119,7 @@ void Board::printBoard() const {
         std::cout << (rank + 1) << " ";
         
         for (int file = 0; file < 8; file++) {
-            std::cout << mBoard[rank][file].toChar() << " ";
+            std::cout << getPiece(rank, file).toChar() << " ";
         }
         
         std::cout << (rank + 1) << std::endl;
@@ -111,22 +128,23 @@ void Board::printBoard() const {
     std::cout << "  a b c d e f g h" << std::endl;
     
     // Print additional state information
-    std::cout << (mColorTurn == PieceColor::WHITE ? "White" : "Black") << " to move" << std::endl;
-    std::cout << "Half moves: " << static_cast<int>(mHalfMove) << std::endl;
-    std::cout << "Full moves: " << static_cast<int>(mFullMove) << std::endl;
+    std::cout << (mPosition.sideToMove == PieceColor::WHITE ? "White" : "Black") << " to move" << std::endl;
+    std::cout << "Castling: ";
+    if (mPosition.castling == NO_CASTLING) std::cout << "-";
+    if (mPosition.castling & WHITE_KINGSIDE) std::cout << "K";
+    if (mPosition.castling & WHITE_QUEENSIDE) std::cout << "Q";
+    if (mPosition.castling & BLACK_KINGSIDE) std::cout << "k";
+    if (mPosition.castling & BLACK_QUEENSIDE) std::cout << "q";
+    std::cout << std::endl;
+    if (mPosition.epSquare != NO_SQUARE)
+        std::cout << "En passant: " << coordsToAlgebraic(rankOf(mPosition.epSquare), fileOf(mPosition.epSquare)) << std::endl;
+    std::cout << "Half moves: " << static_cast<int>(mPosition.halfMove) << std::endl;
+    std::cout << "Full moves: " << static_cast<int>(mPosition.fullMove) << std::endl;
 }
 
 void Board::resetBoard() {
-    for (int rank = 0; rank < 8; rank++) {
-        for (int file = 0; file < 8; file++) {
-            mBoard[rank][file] = Piece();
-        }
-    }
-
-    // Reset game state
-    mColorTurn = PieceColor::WHITE;
-    mHalfMove = 0;
-    mFullMove = 1;
+    // Empty squares and reset game state
+    mPosition.clear();
 }
 
 void Board::setStartingBoard() {
@@ -154,4 +172,7 @@ void Board::setStartingBoard() {
     setPiece(Piece(PieceType::BISHOP, PieceColor::BLACK), 7, 5);
     setPiece(Piece(PieceType::KNIGHT, PieceColor::BLACK), 7, 6);
     setPiece(Piece(PieceType::ROOK, PieceColor::BLACK), 7, 7);
+
+    mPosition.castling = ALL_CASTLING;
+    mPosition.computeKey();
 }
@@ -0,0 +1,192 @@
+#include "ChessBotApi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "Board.h"
+#include "Search.h"
+#include "ThreadPool.h"
+
+struct ChessBotEngine {
+    size_t hashMegabytes = TranspositionTable::DefaultMegabytes;
+    int threads = 1;
+    // kept between moves, its table is what makes later turns cheaper
+    std::unique_ptr<Search> search;
+};
+
+namespace {
+    bool isNumber(const std::string &text, const size_t maxLength) {
+        return !text.empty() && text.size() <= maxLength &&
+               text.find_first_not_of("0123456789") == std::string::npos;
+    }
+
+    // Board takes any text as a FEN, so anything it could trip over is turned away here,
+    // along with positions no game can reach that the search is not made for.
+    // Adds the move counters when they are missing.
+    bool normalizeFen(const char *text, std::string &fen) {
+        std::istringstream fields(text);
+        std::string placement, side, castling, enPassant, halfMove = "0", fullMove = "1";
+        if (!(fields >> placement >> side >> castling >> enPassant))
+            return false;
+        if (fields >> halfMove && !(fields >> fullMove))
+            return false;
+
+        int rank = 0, file = 0, kings[2] = {0, 0};
+        for (const char c: placement) {
+            if (c == '/') {
+                if (file != 8)
+                    return false;
+                rank++;
+                file = 0;
+            } else if (c >= '1' && c <= '8') {
+                file += c - '0';
+            } else if (std::strchr("PNBRQKpnbrqk", c)) {
+                // pawns never stand on the first or last rank
+                if ((c == 'P' || c == 'p') && (rank == 0 || rank == 7))
+                    return false;
+                kings[0] += c == 'K';
+                kings[1] += c == 'k';
+                file++;
+            } else {
+                return false;
+            }
+            if (file > 8)
+                return false;
+        }
+        if (rank != 7 || file != 8 || kings[0] != 1 || kings[1] != 1)
+            return false;
+
+        if ((side != "w" && side != "b") || castling.find_first_not_of("KQkq-") != std::string::npos)
+            return false;
+        if (enPassant != "-" && (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' ||
+                                 (enPassant[1] != '3' && enPassant[1] != '6')))
+            return false;
+        if (!isNumber(halfMove, 4) || !isNumber(fullMove, 4))
+            return false;
+
+        fen = placement + " " + side + " " + castling + " " + enPassant + " " + halfMove + " " + fullMove;
+
+        // with the side that just moved in check the search would go on to capture the king
+        const Board board(fen);
+        const Position &position = board.getPosition();
+        if (position.isInCheck(!position.sideToMove))
+            return false;
+
+        // a castling right needs the king and that rook still on their starting squares
+        for (const char c: castling) {
+            if (c == '-')
+                continue;
+            const PieceColor color = c == 'K' || c == 'Q' ? PieceColor::WHITE : PieceColor::BLACK;
+            const int homeRank = color == PieceColor::WHITE ? 0 : 7;
+            const int rookFile = c == 'K' || c == 'k' ? 7 : 0;
+            if (position.kingSquare(color) != squareOf(homeRank, 4) ||
+                !(position.pieces(color, PieceType::ROOK) & squareBit(squareOf(homeRank, rookFile))))
+                return false;
+        }
+
+        // an en passant square is the empty one an enemy pawn just skipped over
+        if (enPassant != "-") {
+            const bool white = position.sideToMove == PieceColor::WHITE;
+            const int file = enPassant[0] - 'a', rank = enPassant[1] - '1';
+            const Piece pawn = board.getPiece(white ? rank - 1 : rank + 1, file);
+            if (rank != (white ? 5 : 2) || !board.getPiece(rank, file).isEmpty() ||
+                pawn.type != PieceType::PAWN || pawn.color == position.sideToMove)
+                return false;
+        }
+        return true;
+    }
+
+    int searchMove(ChessBotEngine &engine, const char *fen, const int moveTimeMs, char *move, ChessBotStats *stats) {
+        std::string checkedFen;
+        if (!normalizeFen(fen, checkedFen))
+            return CHESSBOT_INVALID_ARGUMENT;
+
+        const auto start = std::chrono::steady_clock::now();
+        SearchLimits limits;
+        limits.moveTime = std::chrono::milliseconds(moveTimeMs);
+        limits.threads = engine.threads;
+        const Move best = engine.search->findBestMove(Board(checkedFen), limits);
+
+        const std::string uci = best.isNull() ? "" : best.toUci();
+        std::memcpy(move, uci.c_str(), uci.size() + 1);
+        if (stats) {
+            stats->depth = engine.search->getDepth();
+            stats->score = engine.search->getScore();
+            stats->nodes = engine.search->getNodes();
+            stats->microseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        return best.isNull() ? CHESSBOT_NO_MOVE : CHESSBOT_OK;
+    }
+}
+
+int chessbot_api_version(void) {
+    return CHESSBOT_API_VERSION;
+}
+
+// No exception may cross into the C host, so every entry point that allocates or
+// searches catches them all and reports a failure instead.
+ChessBotEngine *chessbot_create(void) {
+    try {
+        auto engine = std::make_unique<ChessBotEngine>();
+        engine->search = std::make_unique<Search>(engine->hashMegabytes);
+        return engine.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void chessbot_destroy(ChessBotEngine *engine) {
+    delete engine;
+}
+
+int chessbot_set_option(ChessBotEngine *engine, const char *name, const char *value) {
+    if (!engine || !name || !value)
+        return CHESSBOT_INVALID_ARGUMENT;
+
+    try {
+        const std::string text = value;
+        if (!std::strcmp(name, "hash") && isNumber(text, 6) && std::atoi(value) > 0) {
+            // the old search is only replaced once the new one exists
+            const size_t megabytes = static_cast<size_t>(std::atoi(value));
+            engine->search = std::make_unique<Search>(megabytes);
+            engine->hashMegabytes = megabytes;
+            return CHESSBOT_OK;
+        }
+        if (!std::strcmp(name, "threads") && isNumber(text, 4) && std::atoi(value) > 0) {
+            // every thread keeps a helper search, and more than the pool has cores only queue
+            engine->threads = std::min(std::atoi(value), ThreadPool::shared().size());
+            return CHESSBOT_OK;
+        }
+        return CHESSBOT_INVALID_ARGUMENT;
+    } catch (...) {
+        return CHESSBOT_ERROR;
+    }
+}
+
+void chessbot_new_game(ChessBotEngine *engine) {
+    if (!engine)
+        return;
+    try {
+        engine->search->newGame();
+    } catch (...) {
+        // clearing is the only thing that can fail, and a table that was not cleared still works
+    }
+}
+
+int chessbot_move(ChessBotEngine *engine, const char *fen, const int moveTimeMs, char *move, const size_t moveSize,
+                  ChessBotStats *stats) {
+    if (!engine || !fen || !move || moveSize < 6 || moveTimeMs <= 0)
+        return CHESSBOT_INVALID_ARGUMENT;
+    try {
+        return searchMove(*engine, fen, moveTimeMs, move, stats);
+    } catch (...) {
+        move[0] = '\0';
+        return CHESSBOT_ERROR;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CHESS_COMPETITION_CHESS_BOT_API_H
+#define CHESS_COMPETITION_CHESS_BOT_API_H
+
+/*
+ * C interface of the engine, for hosts that load the chessbotshared library once
+ * and ask it for a move every turn. An engine keeps its transposition table
+ * between calls, so later turns start from what earlier ones found. Only
+ * plain C types cross the boundary and new functions are only ever added, so
+ * a host built against one version keeps working with later ones.
+ *
+ * An engine handles one call at a time; separate engines may be used from
+ * separate threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(CHESSBOT_EXPORTS)
+#define CHESSBOT_API __declspec(dllexport)
+#elif defined(CHESSBOT_SHARED)
+#define CHESSBOT_API __declspec(dllimport)
+#else
+#define CHESSBOT_API
+#endif
+#else
+#define CHESSBOT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHESSBOT_API_VERSION 1
+
+/* results of the calls that can fail */
+#define CHESSBOT_OK 0
+#define CHESSBOT_NO_MOVE 1
+#define CHESSBOT_INVALID_ARGUMENT (-1)
+/* out of memory or another failure inside the engine, which stays usable as it was */
+#define CHESSBOT_ERROR (-2)
+
+typedef struct ChessBotEngine ChessBotEngine;
+
+/* what the search behind the last move got to */
+typedef struct ChessBotStats {
+    int32_t depth;
+    int32_t score; /* centipawns from the point of view of the side to move */
+    uint64_t nodes;
+    uint64_t microseconds;
+} ChessBotStats;
+
+/* CHESSBOT_API_VERSION of the loaded library */
+CHESSBOT_API int chessbot_api_version(void);
+
+/* an engine with the default options, NULL if it cannot be allocated */
+CHESSBOT_API ChessBotEngine *chessbot_create(void);
+
+CHESSBOT_API void chessbot_destroy(ChessBotEngine *engine);
+
+/*
+ * Options, names and values as text:
+ *   "hash"    transposition table size in megabytes, clears the table
+ *   "threads" search threads, 1 by default, at most the cores of the machine
+ * Returns CHESSBOT_INVALID_ARGUMENT for unknown options and bad values, and
+ * CHESSBOT_ERROR when a new table cannot be allocated, keeping the old one.
+ */
+CHESSBOT_API int chessbot_set_option(ChessBotEngine *engine, const char *name, const char *value);
+
+/* forget everything learnt from earlier positions, for a new game */
+CHESSBOT_API void chessbot_new_game(ChessBotEngine *engine);
+
+/*
+ * Search the position for at most moveTimeMs milliseconds and write the best
+ * move in UCI notation, NUL-terminated, to move (6 bytes are always enough).
+ * stats may be NULL. Returns CHESSBOT_NO_MOVE when the side to move has no
+ * legal move, CHESSBOT_INVALID_ARGUMENT for a malformed FEN or buffer, and
+ * CHESSBOT_ERROR when the search fails, with an empty move.
+ */
+CHESSBOT_API int chessbot_move(ChessBotEngine *engine, const char *fen, int moveTimeMs, char *move, size_t moveSize,
+                               ChessBotStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CHESS_COMPETITION_CHESS_BOT_API_H
@@ -0,0 +1,73 @@
+#include "Cuckoo.h"
+
+#include <utility>
+
+#include "Attacks.h"
+#include "Zobrist.h"
+
+namespace {
+    constexpr Attacks::Direction BishopDirections[4] = {
+        Attacks::NORTH_EAST, Attacks::NORTH_WEST, Attacks::SOUTH_EAST, Attacks::SOUTH_WEST
+    };
+    constexpr Attacks::Direction RookDirections[4] = {
+        Attacks::NORTH, Attacks::EAST, Attacks::SOUTH, Attacks::WEST
+    };
+
+    constexpr Bitboard rays(const Attacks::Direction (&directions)[4], const int square) {
+        Bitboard squares = 0;
+        for (const Attacks::Direction direction: directions)
+            squares |= Attacks::Rays[direction][square];
+        return squares;
+    }
+
+    // squares reachable on an empty board
+    constexpr Bitboard pseudoAttacks(const PieceType type, const int square) {
+        switch (type) {
+            case PieceType::KNIGHT: return Attacks::Knight[square];
+            case PieceType::BISHOP: return rays(BishopDirections, square);
+            case PieceType::ROOK: return rays(RookDirections, square);
+            case PieceType::QUEEN: return rays(BishopDirections, square) | rays(RookDirections, square);
+            case PieceType::KING: return Attacks::King[square];
+            default: return 0;
+        }
+    }
+
+    constexpr Cuckoo::Tables buildTables() {
+        Cuckoo::Tables tables{};
+
+        for (const int color: {0, 1}) {
+            for (const PieceType type: {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK,
+                                        PieceType::QUEEN, PieceType::KING}) {
+                const uint64_t *keys = Zobrist::keys.pieces[color][static_cast<int>(type)];
+                for (int from = 0; from < 64; from++) {
+                    // every move once, from the lower square to the higher one
+                    Bitboard targets = pseudoAttacks(type, from) & ~((squareBit(from) << 1) - 1);
+                    while (targets) {
+                        const int to = popLsb(targets);
+                        Move move(from, to);
+                        uint64_t key = keys[from] ^ keys[to] ^ Zobrist::keys.blackToMove;
+
+                        // insert, kicking out whatever sits in the slot until an empty one is found
+                        int slot = Cuckoo::h1(key);
+                        while (true) {
+                            std::swap(tables.keys[slot], key);
+                            std::swap(tables.moves[slot], move);
+                            if (move.isNull())
+                                break;
+                            slot = slot == Cuckoo::h1(key) ? Cuckoo::h2(key) : Cuckoo::h1(key);
+                        }
+                    }
+                }
+            }
+        }
+
+        return tables;
+    }
+
+    // built by the compiler, after the Zobrist keys it depends on
+    constexpr Cuckoo::Tables Table = buildTables();
+}
+
+const Cuckoo::Tables &Cuckoo::tables() {
+    return Table;
+}
@@ -0,0 +1,29 @@
+#ifndef CHESS_COMPETITION_CUCKOO_H
+#define CHESS_COMPETITION_CUCKOO_H
+
+#include <cstdint>
+
+#include "Bitboard.h"
+#include "Move.h"
+
+// Cuckoo hash of every reversible piece move on an empty board, keyed by the
+// Zobrist difference the move makes (piece on both squares plus the side to
+// move). A key difference between the current position and an earlier one
+// that is found here means a single move can repeat that earlier position.
+// See "Detecting upcoming repetitions" by Marcel van Kervinck.
+namespace Cuckoo {
+    constexpr int Size = 8192;
+
+    constexpr int h1(const uint64_t key) { return static_cast<int>(key & (Size - 1)); }
+    constexpr int h2(const uint64_t key) { return static_cast<int>((key >> 16) & (Size - 1)); }
+
+    struct Tables {
+        uint64_t keys[Size];
+        Move moves[Size];
+    };
+
+    // Generated at compile time from the Zobrist keys
+    const Tables &tables();
+} // namespace Cuckoo
+
+#endif //CHESS_COMPETITION_CUCKOO_H
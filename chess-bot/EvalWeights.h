@@ -0,0 +1,93 @@
+#ifndef CHESS_COMPETITION_EVAL_WEIGHTS_H
+#define CHESS_COMPETITION_EVAL_WEIGHTS_H
+
+// Evaluation weights in centipawns. Generated by chesstune, rerun it rather than editing by hand.
+// Source: hand-picked starting values
+namespace EvalWeights {
+    // indexed by PieceType
+    constexpr int PieceValues[7] = {0, 100, 320, 330, 500, 900, 0};
+
+    // indexed by [PieceType][square], from white's point of view with rank 8 on top
+    constexpr int PieceSquare[7][64] = {
+        { // empty
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+           0,   0,   0,   0,   0,   0,   0,   0,
+        },
+        { // pawn
+           0,   0,   0,   0,   0,   0,   0,   0,
+          50,  50,  50,  50,  50,  50,  50,  50,
+          10,  10,  20,  30,  30,  20,  10,  10,
+           5,   5,  10,  25,  25,  10,   5,   5,
+           0,   0,   0,  20,  20,   0,   0,   0,
+           5,  -5, -10,   0,   0, -10,  -5,   5,
+           5,  10,  10, -20, -20,  10,  10,   5,
+           0,   0,   0,   0,   0,   0,   0,   0,
+        },
+        { // knight
+         -50, -40, -30, -30, -30, -30, -40, -50,
+         -40, -20,   0,   0,   0,   0, -20, -40,
+         -30,   0,  10,  15,  15,  10,   0, -30,
+         -30,   5,  15,  20,  20,  15,   5, -30,
+         -30,   0,  15,  20,  20,  15,   0, -30,
+         -30,   5,  10,  15,  15,  10,   5, -30,
+         -40, -20,   0,   5,   5,   0, -20, -40,
+         -50, -40, -30, -30, -30, -30, -40, -50,
+        },
+        { // bishop
+         -20, -10, -10, -10, -10, -10, -10, -20,
+         -10,   0,   0,   0,   0,   0,   0, -10,
+         -10,   0,   5,  10,  10,   5,   0, -10,
+         -10,   5,   5,  10,  10,   5,   5, -10,
+         -10,   0,  10,  10,  10,  10,   0, -10,
+         -10,  10,  10,  10,  10,  10,  10, -10,
+         -10,   5,   0,   0,   0,   0,   5, -10,
+         -20, -10, -10, -10, -10, -10, -10, -20,
+        },
+        { // rook
+           0,   0,   0,   0,   0,   0,   0,   0,
+           5,  10,  10,  10,  10,  10,  10,   5,
+          -5,   0,   0,   0,   0,   0,   0,  -5,
+          -5,   0,   0,   0,   0,   0,   0,  -5,
+          -5,   0,   0,   0,   0,   0,   0,  -5,
+          -5,   0,   0,   0,   0,   0,   0,  -5,
+          -5,   0,   0,   0,   0,   0,   0,  -5,
+           0,   0,   0,   5,   5,   0,   0,   0,
+        },
+        { // queen
+         -20, -10, -10,  -5,  -5, -10, -10, -20,
+         -10,   0,   0,   0,   0,   0,   0, -10,
+         -10,   0,   5,   5,   5,   5,   0, -10,
+          -5,   0,   5,   5,   5,   5,   0,  -5,
+           0,   0,   5,   5,   5,   5,   0,  -5,
+         -10,   5,   5,   5,   5,   5,   0, -10,
+         -10,   0,   5,   0,   0,   0,   0, -10,
+         -20, -10, -10,  -5,  -5, -10, -10, -20,
+        },
+        { // king
+         -30, -40, -40, -50, -50, -40, -40, -30,
+         -30, -40, -40, -50, -50, -40, -40, -30,
+         -30, -40, -40, -50, -50, -40, -40, -30,
+         -30, -40, -40, -50, -50, -40, -40, -30,
+         -20, -30, -30, -40, -40, -30, -30, -20,
+         -10, -20, -20, -20, -20, -20, -20, -10,
+          20,  20,   0,   0,   0,   0,  20,  20,
+          20,  30,  10,   0,   0,  10,  30,  20,
+        },
+    };
+
+    // per safe square reachable, indexed by PieceType
+    constexpr int Mobility[7] = {0, 0, 4, 5, 3, 2, 0};
+
+    // subtracted for the summed weight of the pieces attacking the king zone
+    constexpr int KingDanger[24] = {
+        0, 0, 4, 10, 18, 28, 40, 54, 70, 88, 108, 130, 154, 180, 208, 238, 270, 304, 340, 378, 418, 460, 500, 500
+    };
+} // namespace EvalWeights
+
+#endif //CHESS_COMPETITION_EVAL_WEIGHTS_H
@@ -0,0 +1,102 @@
+#include "Evaluation.h"
+
+#include <algorithm>
+
+#include "Material.h"
+
+namespace {
+    // the tables start at rank 8, white needs to flip the rank to index them
+    int tableIndex(const PieceColor color, const int square) {
+        const int tableRank = color == PieceColor::WHITE ? 7 - rankOf(square) : rankOf(square);
+        return tableRank * 8 + fileOf(square);
+    }
+
+    // material, placement, mobility and king safety of one side, positive is good for that side.
+    // Traced evaluations also count every weight used, with `sign` telling whose side this is.
+    // The pieces of the side are added to the material signature on the way.
+    template<bool Traced>
+    int evaluateSide(const Position &position, const AttackInfo &info, const PieceColor color,
+                     Evaluation::Trace *trace, const int sign, uint64_t &signature) {
+        const int us = static_cast<int>(color);
+        int score = 0;
+
+        for (const PieceType type: {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP,
+                                    PieceType::ROOK, PieceType::QUEEN, PieceType::KING}) {
+            const int t = static_cast<int>(type);
+            Bitboard pieces = position.pieces(color, type);
+            int count = 0;
+            while (pieces) {
+                count++;
+                const int index = tableIndex(color, popLsb(pieces));
+                score += EvalWeights::PieceValues[t] + EvalWeights::PieceSquare[t][index];
+                if constexpr (Traced) {
+                    trace->pieceValues[t] += sign;
+                    trace->pieceSquare[t][index] += sign;
+                }
+            }
+            if (type != PieceType::KING)
+                signature += count * Material::signatureUnit(color, type);
+            score += EvalWeights::Mobility[t] * info.mobility[us][t];
+            if constexpr (Traced)
+                trace->mobility[t] += sign * info.mobility[us][t];
+        }
+
+        // a lone attacker is rarely dangerous, and without a queen the attack mostly fizzles out
+        if (info.kingAttackers[us] >= 2 && position.pieces(!color, PieceType::QUEEN)) {
+            const int danger = std::min(info.kingAttackWeight[us], 23);
+            score -= EvalWeights::KingDanger[danger];
+            if constexpr (Traced)
+                trace->kingDanger[danger] -= sign;
+        }
+
+        return score;
+    }
+
+    // kings belong in the centre once the pieces are gone, the more so the fewer are left
+    int endgameKings(const Position &position, const int phase) {
+        int score = 0;
+        for (const PieceColor color: {PieceColor::WHITE, PieceColor::BLACK}) {
+            const int king = position.kingSquare(color);
+            const int centreDistance = std::max(std::max(3 - fileOf(king), fileOf(king) - 4),
+                                                std::max(3 - rankOf(king), rankOf(king) - 4));
+            score += (color == PieceColor::WHITE ? 1 : -1) * 10 * (3 - centreDistance);
+        }
+        return score * (Material::MaxPhase - phase) / Material::MaxPhase;
+    }
+}
+
+int Evaluation::evaluate(const Board &board) {
+    AttackInfo info;
+    info.compute(board.getPosition());
+    return evaluate(board, info);
+}
+
+int Evaluation::evaluate(const Board &board, const AttackInfo &info) {
+    const Position &position = board.getPosition();
+    uint64_t signature = Material::EmptySignature;
+    int score = evaluateSide<false>(position, info, PieceColor::WHITE, nullptr, 1, signature)
+                - evaluateSide<false>(position, info, PieceColor::BLACK, nullptr, -1, signature);
+
+    const Material::Entry &material = Material::probe(signature);
+    if (material.evaluate) {
+        score = material.evaluate(position, material);
+    } else {
+        score += material.imbalance + endgameKings(position, material.phase);
+
+        // drawish material pulls the score of the side ahead towards zero
+        const PieceColor strong = score > 0 ? PieceColor::WHITE : PieceColor::BLACK;
+        int scale = material.scale[static_cast<int>(strong)];
+        if (material.scaleFunction)
+            scale = std::min(scale, material.scaleFunction(position, strong));
+        score = score * scale / Material::NormalScale;
+    }
+    return position.sideToMove == PieceColor::WHITE ? score : -score;
+}
+
+int Evaluation::evaluate(const Board &board, const AttackInfo &info, Trace &trace) {
+    const Position &position = board.getPosition();
+    trace = {};
+    uint64_t signature = Material::EmptySignature;
+    return evaluateSide<true>(position, info, PieceColor::WHITE, &trace, 1, signature)
+           - evaluateSide<true>(position, info, PieceColor::BLACK, &trace, -1, signature);
+}
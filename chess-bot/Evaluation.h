@@ -0,0 +1,37 @@
+#ifndef CHESS_COMPETITION_EVALUATION_H
+#define CHESS_COMPETITION_EVALUATION_H
+
+#include "Attacks.h"
+#include "Board.h"
+#include "EvalWeights.h"
+
+namespace Evaluation {
+    // Piece values in centipawns, indexed by PieceType
+    inline constexpr const auto &PieceValues = EvalWeights::PieceValues;
+
+    // How often each weight of EvalWeights counted for white minus how often it
+    // counted for black. The evaluation is linear in the weights, so this is all
+    // the tuner needs to know about a position.
+    struct Trace {
+        int pieceValues[7];
+        int pieceSquare[7][64];
+        int mobility[7];
+        int kingDanger[24];
+    };
+
+    /**
+     * @brief Static evaluation of the board
+     *
+     * @return int Score in centipawns from the point of view of the side to move
+     */
+    int evaluate(const Board &board);
+
+    // Same, reusing attack maps already computed for this node
+    int evaluate(const Board &board, const AttackInfo &info);
+
+    // Same, also filling in the trace. The score is from white's point of view here, and
+    // covers only the tuned weights, without the material table's endgame knowledge.
+    int evaluate(const Board &board, const AttackInfo &info, Trace &trace);
+} // namespace Evaluation
+
+#endif //CHESS_COMPETITION_EVALUATION_H
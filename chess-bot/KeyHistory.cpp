@@ -0,0 +1,45 @@
+#include "KeyHistory.h"
+
+#include <algorithm>
+
+#include "Attacks.h"
+#include "Cuckoo.h"
+
+bool KeyHistory::isRepetition(const int halfMove) const {
+    const uint64_t key = mKeys[mSize - 1];
+    const int oldest = std::max(0, mSize - 1 - halfMove);
+
+    // the same side has to be to move, so step back two plies at a time
+    for (int i = mSize - 3; i >= oldest; i -= 2) {
+        if (mKeys[i] == key)
+            return true;
+    }
+    return false;
+}
+
+bool KeyHistory::hasUpcomingRepetition(const Position &position, const int ply) const {
+    const int end = std::min<int>(position.halfMove, mSize - 1);
+    if (end < 3)
+        return false;
+
+    const Cuckoo::Tables &cuckoo = Cuckoo::tables();
+    for (int i = 3; i <= end; i += 2) {
+        // only cycles that close inside the search tree, the root history is not ours to judge
+        if (i >= ply)
+            break;
+
+        const uint64_t moveKey = position.key ^ mKeys[mSize - 1 - i];
+        int slot = Cuckoo::h1(moveKey);
+        if (cuckoo.keys[slot] != moveKey) {
+            slot = Cuckoo::h2(moveKey);
+            if (cuckoo.keys[slot] != moveKey)
+                continue;
+        }
+
+        // the move has to be playable, nothing may stand in the way
+        const Move move = cuckoo.moves[slot];
+        if (!(Attacks::Between[move.from()][move.to()] & position.occupied()))
+            return true;
+    }
+    return false;
+}
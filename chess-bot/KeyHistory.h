@@ -0,0 +1,36 @@
+#ifndef CHESS_COMPETITION_KEYHISTORY_H
+#define CHESS_COMPETITION_KEYHISTORY_H
+
+#include <array>
+#include <cstdint>
+
+#include "Position.h"
+
+// Stack of the Zobrist keys leading to the current position, one per search
+// thread. Only the last `halfMove` entries can ever repeat, since a capture or
+// pawn move makes every earlier position unreachable.
+class KeyHistory {
+public:
+    static constexpr int Capacity = 1024;
+
+    void clear() { mSize = 0; }
+
+    void push(const uint64_t key) { mKeys[mSize++] = key; }
+
+    void pop() { mSize--; }
+
+    int size() const { return mSize; }
+
+    // The top of the stack already occurred within the reversible part of the history
+    bool isRepetition(int halfMove) const;
+
+    // The side to move can repeat a position of the search with a single reversible
+    // move, so the node is worth at least a draw
+    bool hasUpcomingRepetition(const Position &position, int ply) const;
+
+private:
+    std::array<uint64_t, Capacity> mKeys;
+    int mSize = 0;
+};
+
+#endif //CHESS_COMPETITION_KEYHISTORY_H
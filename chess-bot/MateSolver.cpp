@@ -0,0 +1,237 @@
+#include "MateSolver.h"
+
+#include <algorithm>
+#include <bit>
+
+MateSolver::MateSolver(const size_t megabytes) : mFrames(2 * MaxMoves) {
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= std::max<size_t>(megabytes, 1) << 20)
+        count *= 2;
+    mBuckets = std::make_unique<Bucket[]>(count);
+    mBucketMask = count - 1;
+}
+
+MateStatus MateSolver::solve(const Board &board, const MateLimits &limits) {
+    mLimits = limits;
+    mLimits.maxMoves = std::clamp(limits.maxMoves, 1, MaxMoves);
+    mStartTime = std::chrono::steady_clock::now();
+    mStopped = false;
+    mNodes = 0;
+    mNextCheck = 0;
+    mMateMoves = 0;
+    mLine.clear();
+
+    const Position &root = board.getPosition();
+    for (int moves = 1; moves <= mLimits.maxMoves; moves++) {
+        const int depth = 2 * moves - 1;
+        Numbers numbers = evaluate(root, tableKey(root.key, depth), depth);
+        if (numbers.phi && numbers.delta)
+            numbers = mid(root, depth, 0, Infinite, Infinite);
+
+        if (numbers.phi == 0) {
+            mMateMoves = moves;
+            extractLine(board, depth);
+            return MateStatus::PROVEN;
+        }
+        if (numbers.delta != 0)
+            return MateStatus::UNKNOWN;
+        mMateMoves = moves;
+    }
+    return MateStatus::DISPROVEN;
+}
+
+MateSolver::Numbers MateSolver::mid(const Position &position, const int depth, const int ply,
+                                    const uint32_t phiThreshold, const uint32_t deltaThreshold) {
+    const uint64_t startNodes = mNodes;
+    Frame &frame = mFrames[ply];
+    MoveList &moves = frame.moves;
+    generate(position, depth, moves);
+    for (int i = 0; i < moves.size; i++) {
+        Position child;
+        copyMake(child, position, moves[i]);
+        frame.numbers[i] = evaluate(child, tableKey(child.key, depth - 1), depth - 1);
+    }
+
+    Numbers numbers{};
+    int best = 0;
+    int searched = -1;
+    while (true) {
+        // phi is the best delta of a child, delta the sum of their phis
+        uint32_t second = Infinite;
+        uint64_t sum = 0;
+        numbers.phi = Infinite;
+        for (int i = 0; i < moves.size; i++) {
+            const Numbers child = frame.numbers[i];
+            if (child.delta < numbers.phi) {
+                second = numbers.phi;
+                numbers.phi = child.delta;
+                best = i;
+            } else if (child.delta < second) {
+                second = child.delta;
+            }
+            sum += child.phi;
+        }
+        // only a won node has an infinite delta, a large sum stays just below it
+        numbers.delta = numbers.phi == 0 ? Infinite : static_cast<uint32_t>(std::min<uint64_t>(sum, Infinite - 1));
+
+        if (numbers.phi >= phiThreshold || numbers.delta >= deltaThreshold || shouldStop())
+            break;
+
+        // the child may use what the others leave of our delta threshold, and should
+        // give way once it is a good deal worse than the second best
+        const uint64_t childPhi = static_cast<uint64_t>(deltaThreshold) - numbers.delta + frame.numbers[best].phi;
+        const uint64_t childDelta = std::min<uint64_t>(phiThreshold, second + second / 4 + 1);
+
+        Position child;
+        copyMake(child, position, moves[best]);
+        frame.numbers[best] = mid(child, depth - 1, ply + 1,
+                                  static_cast<uint32_t>(std::min<uint64_t>(childPhi, Infinite)),
+                                  static_cast<uint32_t>(childDelta));
+        searched = best;
+    }
+
+    // a lost node remembers the move refuted last, the stubbornest defence
+    const Move bestMove = numbers.delta == 0 && searched >= 0 ? moves[searched] : moves[best];
+    store(tableKey(position.key, depth), numbers, bestMove, mNodes - startNodes);
+    return numbers;
+}
+
+MateSolver::Numbers MateSolver::evaluate(const Position &position, const uint64_t key, const int depth) {
+    mNodes++;
+    Entry entry;
+    if (probe(key, entry))
+        return {entry.phi, entry.delta};
+
+    MoveList moves;
+    generate(position, depth, moves);
+
+    // the attacker moves with an odd number of plies left, the defender with an even one
+    const bool attacker = depth % 2 == 1;
+    Numbers numbers;
+    if (moves.size == 0) {
+        // out of moves, or of checks, the attacker has lost; the defender only when mated
+        const bool lost = attacker || position.isInCheck(position.sideToMove);
+        numbers = lost ? Numbers{Infinite, 0} : Numbers{0, Infinite};
+    } else if (depth == 0) {
+        numbers = {0, Infinite};
+    } else {
+        // the more moves there are, the more of them the opponent has to answer
+        numbers = {1, static_cast<uint32_t>(moves.size)};
+    }
+    store(key, numbers, Move(), 0);
+    return numbers;
+}
+
+void MateSolver::generate(const Position &position, const int depth, MoveList &moves) const {
+    AttackInfo info;
+    info.compute(position);
+    ::generateMoves<GenType::ALL>(position, info, moves);
+
+    // with one move left only a check can mate
+    if (depth % 2 == 0 || (!mLimits.checksOnly && depth > 1))
+        return;
+    int kept = 0;
+    for (const Move move: moves) {
+        Position child;
+        copyMake(child, position, move);
+        if (child.isInCheck(child.sideToMove))
+            moves[kept++] = move;
+    }
+    moves.size = kept;
+}
+
+bool MateSolver::probe(const uint64_t key, Entry &entry) const {
+    const Bucket &bucket = mBuckets[key & mBucketMask];
+    const auto check = static_cast<uint32_t>(key >> 32);
+    for (const Entry &candidate: bucket.entries) {
+        // no stored position has both numbers at zero, so that marks an empty slot
+        if (candidate.check == check && (candidate.phi | candidate.delta)) {
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MateSolver::store(const uint64_t key, const Numbers numbers, const Move best, const uint64_t nodes) {
+    Bucket &bucket = mBuckets[key & mBucketMask];
+    const auto check = static_cast<uint32_t>(key >> 32);
+    Entry *slot = &bucket.entries[0];
+    for (Entry &candidate: bucket.entries) {
+        if (candidate.check == check) {
+            slot = &candidate;
+            break;
+        }
+        if (candidate.work < slot->work)
+            slot = &candidate;
+    }
+    *slot = {check, numbers.phi, numbers.delta, best, static_cast<uint8_t>(std::bit_width(nodes)), 0};
+}
+
+uint64_t MateSolver::tableKey(const uint64_t key, const int depth) const {
+    const uint64_t mode = mLimits.checksOnly ? 2 * MaxMoves : 0;
+    return key ^ (depth + mode + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+int MateSolver::provenDepth(const Position &position, const int depth) const {
+    for (int shorter = 1; shorter < depth; shorter += 2) {
+        Entry entry;
+        if (probe(tableKey(position.key, shorter), entry) && entry.phi == 0)
+            return shorter;
+    }
+    return depth;
+}
+
+void MateSolver::extractLine(const Board &board, int depth) {
+    Position position = board.getPosition();
+    while (depth > 0) {
+        MoveList moves;
+        AttackInfo info;
+        info.compute(position);
+        ::generateMoves<GenType::ALL>(position, info, moves);
+
+        Move move;
+        if (depth % 2 == 1) {
+            // the attacker takes the quickest mate the table knows of
+            depth = provenDepth(position, depth);
+            Entry entry;
+            if (!probe(tableKey(position.key, depth), entry))
+                break;
+            move = entry.best;
+            // a key collision could leave a move of another position
+            if (std::find(moves.begin(), moves.end(), move) == moves.end())
+                break;
+        } else {
+            // the defender plays the reply that holds out longest
+            int longest = -1;
+            for (const Move reply: moves) {
+                Position child;
+                copyMake(child, position, reply);
+                const int mate = provenDepth(child, depth - 1);
+                if (mate > longest) {
+                    longest = mate;
+                    move = reply;
+                }
+            }
+            if (move.isNull())
+                break;
+        }
+
+        mLine.push_back(move);
+        position.makeMove(move);
+        depth--;
+    }
+}
+
+bool MateSolver::shouldStop() {
+    if (mStopped || mNodes < mNextCheck)
+        return mStopped;
+
+    // the clock is only read every thousand nodes or so
+    mNextCheck = mNodes + 1024;
+    if ((mLimits.stop && mLimits.stop->load(std::memory_order_relaxed)) || mNodes >= mLimits.maxNodes ||
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - mStartTime) >= mLimits.moveTime)
+        mStopped = true;
+    return mStopped;
+}
@@ -0,0 +1,132 @@
+#ifndef CHESS_COMPETITION_MATE_SOLVER_H
+#define CHESS_COMPETITION_MATE_SOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+
+struct MateLimits {
+    // mate in at most this many moves of the side to move
+    int maxMoves = 8;
+    std::chrono::milliseconds moveTime = std::chrono::milliseconds::max();
+    uint64_t maxNodes = UINT64_MAX;
+    // the attacking side only gives check, much faster but blind to quiet mating moves
+    bool checksOnly = false;
+    // stops the solver from another thread when set, may be null
+    const std::atomic<bool> *stop = nullptr;
+};
+
+enum class MateStatus : uint8_t {
+    UNKNOWN, // the limits ran out first
+    PROVEN, // a forced mate, the line is in getLine
+    DISPROVEN // no forced mate within maxMoves
+};
+
+// Depth-first proof-number search for forced mates by the side to move. Where
+// alpha-beta gives every move the same depth, proof numbers count how many
+// positions still have to be settled and always expand the line that needs
+// the fewest, so narrow forcing lines are followed far past what a full-width
+// search reaches in the same time.
+//
+// Mates are tried one move longer at a time, so the first proof is the
+// shortest. The remaining plies are part of every table key, which keeps the
+// graph acyclic: a position only ever repeats with fewer plies left, so
+// repetitions need no special care. The fifty-move rule is not looked at.
+class MateSolver {
+public:
+    static constexpr size_t DefaultMegabytes = 4;
+    static constexpr int MaxMoves = 32;
+
+    explicit MateSolver(size_t megabytes = DefaultMegabytes);
+
+    MateSolver(const MateSolver &) = delete;
+    MateSolver &operator=(const MateSolver &) = delete;
+
+    /**
+     * @brief Look for the shortest forced mate by the side to move
+     *
+     * Settled positions stay in the table, so solving a position after an earlier one is often cheaper.
+     *
+     * @return MateStatus PROVEN with the mate in getLine, DISPROVEN if there is none within the limits' moves
+     */
+    MateStatus solve(const Board &board, const MateLimits &limits);
+
+    // moves of the side to move until mate, or the longest mate that was ruled out
+    int getMateMoves() const { return mMateMoves; }
+    // the mating line, each defence is the reply with the longest mate the table knows of
+    const std::vector<Move> &getLine() const { return mLine; }
+    uint64_t getNodes() const { return mNodes; }
+
+private:
+    // proof and disproof numbers from the point of view of the side to move:
+    // phi is zero once it has won, delta is zero once it has lost
+    struct Numbers {
+        uint32_t phi;
+        uint32_t delta;
+    };
+
+    // 16 bytes, four to a cache line
+    struct Entry {
+        uint32_t check;
+        uint32_t phi;
+        uint32_t delta;
+        Move best;
+        // log2 of the nodes spent on the entry, the cheapest entry of a bucket is replaced
+        uint8_t work;
+        uint8_t unused;
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    // the children of the node at each ply
+    struct Frame {
+        MoveList moves;
+        Numbers numbers[256];
+    };
+
+    static constexpr uint32_t Infinite = 1u << 30;
+
+    Numbers mid(const Position &position, int depth, int ply, uint32_t phiThreshold, uint32_t deltaThreshold);
+
+    // first look at a position, from the table or from its moves
+    Numbers evaluate(const Position &position, uint64_t key, int depth);
+
+    // the moves of the node, only checks for the attacker when they are all that can mate
+    void generate(const Position &position, int depth, MoveList &moves) const;
+
+    bool probe(uint64_t key, Entry &entry) const;
+
+    void store(uint64_t key, Numbers numbers, Move best, uint64_t nodes);
+
+    // the table key of a position with `depth` plies left, in the current mode
+    uint64_t tableKey(uint64_t key, int depth) const;
+
+    // the fewest plies, at most `depth`, the table has a mate for the side to move in
+    int provenDepth(const Position &position, int depth) const;
+
+    void extractLine(const Board &board, int depth);
+
+    bool shouldStop();
+
+    std::unique_ptr<Bucket[]> mBuckets;
+    size_t mBucketMask = 0;
+    std::vector<Frame> mFrames;
+
+    MateLimits mLimits;
+    std::chrono::steady_clock::time_point mStartTime;
+    bool mStopped = false;
+    uint64_t mNodes = 0;
+    uint64_t mNextCheck = 0;
+    int mMateMoves = 0;
+    std::vector<Move> mLine;
+};
+
+#endif //CHESS_COMPETITION_MATE_SOLVER_H
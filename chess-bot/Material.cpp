@@ -0,0 +1,218 @@
+#include "Material.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "EvalWeights.h"
+
+namespace {
+    constexpr int TableBits = 12;
+    // beyond any ordinary evaluation and far below the mate scores
+    constexpr int KnownWin = 10000;
+    constexpr int BishopPair = 30;
+
+    // fixed piece weights in pawns for telling endgames apart, indexed by PieceType; the tuned
+    // values would shift with every tuning run and could make two configurations compare equal
+    constexpr int PieceUnits[7] = {0, 1, 3, 3, 5, 9, 0};
+    constexpr int MinorUnits = 3;
+    constexpr int RookUnits = 5;
+
+    // about 128 KB a thread, more than the material configurations a search runs into
+    thread_local Material::Entry table[1 << TableBits];
+
+    // counts of pawns to queens, indexed by [PieceColor][PieceType]
+    struct Counts {
+        int pieces[2][7];
+        // knights to queens
+        int nonPawn[2];
+        // the same in PieceUnits
+        int units[2];
+
+        explicit Counts(const uint64_t signature) : pieces{}, nonPawn{}, units{} {
+            for (int color = 0; color < 2; color++) {
+                for (int type = 1; type <= 5; type++) {
+                    pieces[color][type] = static_cast<int>(signature >> ((color * 5 + type - 1) * 4) & 0xF);
+                    if (type > 1) {
+                        nonPawn[color] += pieces[color][type];
+                        units[color] += pieces[color][type] * PieceUnits[type];
+                    }
+                }
+            }
+        }
+
+        int count(const PieceColor color, const PieceType type) const {
+            return pieces[static_cast<int>(color)][static_cast<int>(type)];
+        }
+
+        int nonPawnCount(const PieceColor color) const { return nonPawn[static_cast<int>(color)]; }
+
+        int nonPawnUnits(const PieceColor color) const { return units[static_cast<int>(color)]; }
+
+        bool isBare(const PieceColor color) const { return !nonPawnCount(color) && !count(color, PieceType::PAWN); }
+
+        // exactly one piece of this type and nothing else but pawns
+        bool hasOnly(const PieceColor color, const PieceType type) const {
+            return count(color, type) == 1 && nonPawnCount(color) == 1;
+        }
+    };
+
+    int distance(const int a, const int b) {
+        return std::max(std::abs(fileOf(a) - fileOf(b)), std::abs(rankOf(a) - rankOf(b)));
+    }
+
+    // 0 on the four centre squares up to 3 on the edge
+    int centreDistance(const int square) {
+        return std::max(std::max(3 - fileOf(square), fileOf(square) - 4), std::max(3 - rankOf(square), rankOf(square) - 4));
+    }
+
+    bool isDarkSquare(const int square) { return (fileOf(square) + rankOf(square)) % 2 == 0; }
+
+    // a1, the corner isDarkSquare starts from, and every square of its colour
+    constexpr Bitboard DarkSquares = 0xAA55AA55AA55AA55ULL;
+
+    int relativeRank(const PieceColor color, const int square) {
+        return color == PieceColor::WHITE ? rankOf(square) : 7 - rankOf(square);
+    }
+
+    int materialOf(const Position &position, const PieceColor color) {
+        int material = 0;
+        for (int type = 1; type <= 5; type++)
+            material += popCount(position.pieces(color, static_cast<PieceType>(type))) * EvalWeights::PieceValues[type];
+        return material;
+    }
+
+    int forWhite(const PieceColor strong, const int score) { return strong == PieceColor::WHITE ? score : -score; }
+
+    // enough to mate a bare king: drive it to the edge and bring the kings together
+    int evaluateKXK(const Position &position, const Material::Entry &entry) {
+        const int strongKing = position.kingSquare(entry.strong);
+        const int weakKing = position.kingSquare(!entry.strong);
+        const int score = KnownWin + materialOf(position, entry.strong) + 30 * centreDistance(weakKing) +
+                          10 * (7 - distance(strongKing, weakKing));
+        return forWhite(entry.strong, score);
+    }
+
+    // bishop and knight only mate in a corner the bishop covers
+    int evaluateKBNK(const Position &position, const Material::Entry &entry) {
+        const int strongKing = position.kingSquare(entry.strong);
+        const int weakKing = position.kingSquare(!entry.strong);
+        const bool darkBishop = isDarkSquare(lsb(position.pieces(entry.strong, PieceType::BISHOP)));
+        const int corner = darkBishop
+                               ? std::min(distance(weakKing, squareOf(0, 0)), distance(weakKing, squareOf(7, 7)))
+                               : std::min(distance(weakKing, squareOf(0, 7)), distance(weakKing, squareOf(7, 0)));
+        const int score = KnownWin + materialOf(position, entry.strong) + 40 * (7 - corner) +
+                          10 * (7 - distance(strongKing, weakKing));
+        return forWhite(entry.strong, score);
+    }
+
+    // bishops alone only mate with one on each colour, underpromotion can leave them all on one
+    int evaluateKBBK(const Position &position, const Material::Entry &entry) {
+        const Bitboard bishops = position.pieces(entry.strong, PieceType::BISHOP);
+        if (!(bishops & DarkSquares) || !(bishops & ~DarkSquares))
+            return 0;
+        return evaluateKXK(position, entry);
+    }
+
+    // bishops on opposite colours hold most pawn endgames a pawn or two down
+    int scaleOppositeBishops(const Position &position, const PieceColor strong) {
+        const Bitboard bishops = position.diagonals & ~position.orthogonals;
+        if (isDarkSquare(lsb(bishops & position.pieces(strong))) == isDarkSquare(lsb(bishops & position.pieces(!strong))))
+            return Material::NormalScale;
+        const int extraPawns = popCount(position.pieces(strong, PieceType::PAWN)) -
+                               popCount(position.pieces(!strong, PieceType::PAWN));
+        return extraPawns <= 1 ? 16 : 32;
+    }
+
+    // rook and pawn against rook is drawn with the defending king in front of the pawn
+    int scaleKRPKR(const Position &position, const PieceColor strong) {
+        const Bitboard pawns = position.pieces(strong, PieceType::PAWN);
+        if (!pawns)
+            return Material::NormalScale;
+        const int pawn = lsb(pawns);
+        const int weakKing = position.kingSquare(!strong);
+        if (fileOf(weakKing) == fileOf(pawn) && relativeRank(strong, weakKing) > relativeRank(strong, pawn))
+            return 16;
+        return Material::NormalScale;
+    }
+
+    // rook pawns with a bishop that does not cover the promotion square cannot get past a king in the corner
+    int scaleKBPsK(const Position &position, const PieceColor strong) {
+        const Bitboard pawns = position.pieces(strong, PieceType::PAWN);
+        const Bitboard bishops = position.pieces(strong, PieceType::BISHOP);
+        if (!pawns || !bishops)
+            return Material::NormalScale;
+        const bool fileA = !(pawns & ~FileABitboard);
+        if (!fileA && (pawns & ~FileHBitboard))
+            return Material::NormalScale;
+
+        const int promotion = squareOf(strong == PieceColor::WHITE ? 7 : 0, fileA ? 0 : 7);
+        if (isDarkSquare(promotion) != isDarkSquare(lsb(bishops)) && distance(position.kingSquare(!strong), promotion) <= 1)
+            return 0;
+        return Material::NormalScale;
+    }
+}
+
+const Material::Entry &Material::probe(const uint64_t signature) {
+    Entry &entry = table[signature * 0x9E3779B97F4A7C15ULL >> (64 - TableBits)];
+    if (entry.signature != signature)
+        entry = analyse(signature);
+    return entry;
+}
+
+Material::Entry Material::analyse(const uint64_t signature) {
+    Entry entry{};
+    entry.signature = signature;
+    entry.strong = PieceColor::WHITE;
+    entry.scale[0] = entry.scale[1] = NormalScale;
+
+    const Counts counts(signature);
+    int phase = 0;
+    for (const PieceColor color: {PieceColor::WHITE, PieceColor::BLACK}) {
+        phase += counts.count(color, PieceType::KNIGHT) + counts.count(color, PieceType::BISHOP) +
+                 2 * counts.count(color, PieceType::ROOK) + 4 * counts.count(color, PieceType::QUEEN);
+        if (counts.count(color, PieceType::BISHOP) >= 2)
+            entry.imbalance += forWhite(color, BishopPair);
+    }
+    entry.phase = static_cast<uint8_t>(std::min(phase, MaxPhase));
+
+    for (const PieceColor strong: {PieceColor::WHITE, PieceColor::BLACK}) {
+        const PieceColor weak = !strong;
+        const int strongUnits = counts.nonPawnUnits(strong);
+        const int knights = counts.count(strong, PieceType::KNIGHT);
+        const int bishops = counts.count(strong, PieceType::BISHOP);
+        const int minors = knights + bishops;
+
+        // known wins against a bare king
+        if (counts.isBare(weak) && !counts.count(strong, PieceType::PAWN)) {
+            if (knights == 1 && bishops == 1 && counts.nonPawnCount(strong) == 2) {
+                entry.evaluate = evaluateKBNK;
+                entry.strong = strong;
+            } else if (bishops == counts.nonPawnCount(strong)) {
+                if (bishops >= 2) {
+                    entry.evaluate = evaluateKBBK;
+                    entry.strong = strong;
+                }
+            } else if (minors != counts.nonPawnCount(strong) || minors >= 3) {
+                entry.evaluate = evaluateKXK;
+                entry.strong = strong;
+            }
+        }
+
+        // without pawns a side needs more than a minor piece up to win
+        if (!counts.count(strong, PieceType::PAWN) && strongUnits - counts.nonPawnUnits(weak) <= MinorUnits)
+            entry.scale[static_cast<int>(strong)] = strongUnits < RookUnits ? 0 : 16;
+        if (!counts.count(strong, PieceType::PAWN) && knights == 2 && counts.nonPawnCount(strong) == 2 &&
+            counts.isBare(weak))
+            entry.scale[static_cast<int>(strong)] = 0;
+
+        if (counts.hasOnly(strong, PieceType::ROOK) && counts.count(strong, PieceType::PAWN) == 1 &&
+            counts.hasOnly(weak, PieceType::ROOK) && !counts.count(weak, PieceType::PAWN))
+            entry.scaleFunction = scaleKRPKR;
+        if (counts.hasOnly(strong, PieceType::BISHOP) && counts.count(strong, PieceType::PAWN) && counts.isBare(weak))
+            entry.scaleFunction = scaleKBPsK;
+    }
+
+    if (counts.hasOnly(PieceColor::WHITE, PieceType::BISHOP) && counts.hasOnly(PieceColor::BLACK, PieceType::BISHOP))
+        entry.scaleFunction = scaleOppositeBishops;
+    return entry;
+}
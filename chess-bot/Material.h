@@ -0,0 +1,61 @@
+#ifndef CHESS_COMPETITION_MATERIAL_H
+#define CHESS_COMPETITION_MATERIAL_H
+
+#include <cstdint>
+
+#include "Position.h"
+
+// Everything in the evaluation that depends only on which pieces are on the
+// board, worked out once per material configuration and cached in a small
+// table per thread. The signature packs the piece counts into one word, so
+// entries are exact. The evaluation walks every piece anyway and adds up the
+// signature on the way, which leaves a single load for the probe.
+namespace Material {
+    constexpr int MaxPhase = 24;
+    // scale factors are out of this, applied to the score of the side ahead
+    constexpr int NormalScale = 64;
+
+    struct Entry;
+
+    // replaces the whole evaluation, returns a score for white
+    using EvaluateFunction = int (*)(const Position &position, const Entry &entry);
+
+    // scale factor for `strong`, the side ahead, in place of Entry::scale
+    using ScaleFunction = int (*)(const Position &position, PieceColor strong);
+
+    struct Entry {
+        uint64_t signature;
+        // set for known endgames that need no general evaluation
+        EvaluateFunction evaluate;
+        // set for endgames whose drawing chances depend on where the pieces stand
+        ScaleFunction scaleFunction;
+        // bonuses for material combinations, for white
+        int16_t imbalance;
+        // from MaxPhase with all pieces on down to zero with only pawns and kings
+        uint8_t phase;
+        // the side that can win, for evaluate
+        PieceColor strong;
+        // indexed by PieceColor, for when that side is ahead
+        uint8_t scale[2];
+    };
+
+    // the signature of bare kings, never zero so an empty table slot matches nothing
+    constexpr uint64_t EmptySignature = 1ULL << 63;
+
+    // Four bits per piece type and colour, pawns to queens: one piece adds this to the signature
+    constexpr uint64_t signatureUnit(const PieceColor color, const PieceType type) {
+        return 1ULL << ((static_cast<int>(color) * 5 + static_cast<int>(type) - 1) * 4);
+    }
+
+    /**
+     * @brief The entry for a signature, built on the first visit to its material
+     *
+     * The table belongs to the calling thread, the entry stays valid until the thread probes again.
+     */
+    const Entry &probe(uint64_t signature);
+
+    // Builds the entry from scratch, without the table
+    Entry analyse(uint64_t signature);
+} // namespace Material
+
+#endif //CHESS_COMPETITION_MATERIAL_H
@@ -0,0 +1,347 @@
+#include "Mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Attacks.h"
+#include "Evaluation.h"
+#include "ThreadPool.h"
+
+namespace {
+    // centipawns for which a position counts as about three quarters won
+    constexpr float EvalScale = 400.0f;
+    constexpr float FirstPlayReduction = 0.1f;
+    // a thread adds about five million nodes a second, this leaves some room above that
+    constexpr uint64_t NodesPerThreadMillisecond = 8192;
+
+    // xorshift64*, each thread keeps its own state
+    uint64_t nextRandom(uint64_t &state) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    void resetNode(MctsNode &node, const Move move, const float prior) {
+        node.firstChild.store(MctsNode::NoChild, std::memory_order_relaxed);
+        node.state.store(MctsNode::UNEXPANDED, std::memory_order_relaxed);
+        node.childCount = 0;
+        node.move = move;
+        node.prior = prior;
+        node.visits.store(0, std::memory_order_relaxed);
+        node.virtualLoss.store(0, std::memory_order_relaxed);
+        node.valueSum.store(0, std::memory_order_relaxed);
+    }
+
+    void copyNode(MctsNode &to, const MctsNode &from) {
+        resetNode(to, from.move, from.prior);
+        // a node another thread was still expanding has no usable children
+        const uint8_t state = from.state.load(std::memory_order_relaxed);
+        if (state != MctsNode::EXPANDING) {
+            to.state.store(state, std::memory_order_relaxed);
+            to.firstChild.store(from.firstChild.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.childCount = from.childCount;
+        }
+        to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.valueSum.store(from.valueSum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+Mcts::Mcts(const uint32_t capacity)
+    : mCapacity(std::max(capacity, MinCapacity)),
+      mNodes(std::make_unique<MctsNode[]>(mCapacity)),
+      mSpare(std::make_unique<MctsNode[]>(mCapacity)) {
+}
+
+uint32_t Mcts::capacityFor(const std::chrono::milliseconds moveTime, const int threads) {
+    const uint64_t milliseconds = std::clamp<int64_t>(moveTime.count(), 1, 3600 * 1000);
+    const uint64_t nodes = milliseconds * std::max(threads, 1) * NodesPerThreadMillisecond;
+    return static_cast<uint32_t>(std::clamp<uint64_t>(nodes, MinCapacity, DefaultCapacity));
+}
+
+Move Mcts::findBestMove(const Board &board, const MctsLimits &limits) {
+    mLimits = limits;
+    mStartTime = std::chrono::steady_clock::now();
+    mPlayoutCount = 0;
+    mStopped = false;
+
+    const uint32_t reusable = mHasTree ? findReusable(board) : MctsNode::NoChild;
+    if (reusable != MctsNode::NoChild) {
+        reroot(reusable);
+    } else {
+        resetNode(mNodes[0], Move(), 1.0f);
+        mNext = 1;
+        mRoot = 0;
+    }
+    mRootBoard = board;
+    mHasTree = true;
+
+    uint64_t random = 0x9E3779B97F4A7C15ULL;
+    if (mNodes[mRoot].state.load() == MctsNode::UNEXPANDED)
+        expand(mRoot, board, random);
+
+    const MctsNode &root = mNodes[mRoot];
+    if (root.state.load() != MctsNode::EXPANDED || root.childCount == 0) {
+        mPlayouts = 0;
+        mScore = 0;
+        return Move();
+    }
+
+    const int threads = limits.threads > 0
+                            ? limits.threads
+                            : ThreadPool::shared().size();
+    ThreadPool::Batch helpers(ThreadPool::shared());
+    for (int i = 1; i < threads; i++)
+        helpers.submit([this, i] { worker(i); });
+    worker(0);
+    helpers.wait();
+
+    mPlayouts = mPlayoutCount;
+    mUsed = std::min(mNext.load(), mCapacity);
+
+    const uint32_t first = root.firstChild.load();
+    uint32_t best = first;
+    for (uint32_t child = first; child < first + root.childCount; child++) {
+        if (mNodes[child].visits.load() > mNodes[best].visits.load())
+            best = child;
+    }
+
+    const MctsNode &chosen = mNodes[best];
+    const uint32_t visits = chosen.visits.load();
+    const float value = visits ? static_cast<float>(chosen.valueSum.load()) / ValueScale / visits : 0.0f;
+    mScore = static_cast<int>(EvalScale * std::atanh(std::clamp(value, -0.999f, 0.999f)));
+    return chosen.move;
+}
+
+void Mcts::worker(const int index) {
+    uint64_t random = 0x2545F4914F6CDD1DULL * (index + 1);
+    uint64_t local = 0;
+    while (!mStopped.load(std::memory_order_relaxed)) {
+        playout(random);
+
+        if (mPlayoutCount.fetch_add(1, std::memory_order_relaxed) + 1 >= mLimits.maxPlayouts)
+            mStopped = true;
+
+        // checking the clock is expensive, only do it every few playouts, and in
+        // milliseconds since an unlimited moveTime would overflow in nanoseconds
+        if ((++local & 63) == 0 && ((mLimits.stop && mLimits.stop->load(std::memory_order_relaxed)) ||
+                                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        std::chrono::steady_clock::now() - mStartTime) >= mLimits.moveTime))
+            mStopped = true;
+    }
+}
+
+void Mcts::playout(uint64_t &random) {
+    Board board = mRootBoard;
+    uint32_t path[MaxTreeDepth];
+    uint64_t keys[MaxTreeDepth];
+    int length = 0;
+
+    uint32_t node = mRoot;
+    path[length] = node;
+    keys[length++] = board.getPosition().key;
+
+    // value of the last node on the path for the side to move there
+    float value;
+    while (true) {
+        const uint8_t state = mNodes[node].state.load(std::memory_order_acquire);
+        if (state == MctsNode::MATED) {
+            value = -1.0f;
+            break;
+        }
+        if (state == MctsNode::DRAWN) {
+            value = 0.0f;
+            break;
+        }
+        if (state != MctsNode::EXPANDED) {
+            value = expand(node, board, random);
+            break;
+        }
+        if (length == MaxTreeDepth) {
+            value = evaluate(board, random);
+            break;
+        }
+
+        node = selectChild(node);
+        mNodes[node].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+        board.makeMove(mNodes[node].move);
+        path[length] = node;
+        keys[length++] = board.getPosition().key;
+
+        // repetitions and the fifty move rule depend on the path, so they are not stored in the tree
+        const Position &position = board.getPosition();
+        bool repeated = position.halfMove >= 100;
+        for (int i = length - 3; i >= 0 && i >= length - 1 - position.halfMove && !repeated; i -= 2)
+            repeated = keys[i] == keys[length - 1];
+        if (repeated) {
+            value = 0.0f;
+            break;
+        }
+    }
+
+    // every node holds the result for the side that played its move, which alternates going up
+    float result = -value;
+    for (int i = length - 1; i >= 0; i--) {
+        MctsNode &current = mNodes[path[i]];
+        current.valueSum.fetch_add(std::llround(result * ValueScale), std::memory_order_relaxed);
+        current.visits.fetch_add(1, std::memory_order_relaxed);
+        if (i > 0)
+            current.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+        result = -result;
+    }
+}
+
+float Mcts::expand(const uint32_t index, const Board &board, uint64_t &random) {
+    MctsNode &node = mNodes[index];
+    const Position &position = board.getPosition();
+
+    AttackInfo info;
+    info.compute(position);
+    MoveList moves;
+    board.getLegalMoves(moves, info);
+
+    // another thread got here first, or the pool is full, either way this stays a leaf for now
+    uint8_t expected = MctsNode::UNEXPANDED;
+    if (mNext.load(std::memory_order_relaxed) + moves.size > mCapacity ||
+        !node.state.compare_exchange_strong(expected, MctsNode::EXPANDING, std::memory_order_acq_rel))
+        return evaluate(board, random);
+
+    if (moves.size == 0) {
+        const bool mated = info.checkers != 0;
+        node.state.store(mated ? MctsNode::MATED : MctsNode::DRAWN, std::memory_order_release);
+        return mated ? -1.0f : 0.0f;
+    }
+
+    const uint32_t first = mNext.fetch_add(moves.size, std::memory_order_relaxed);
+    if (first + moves.size > mCapacity) {
+        node.state.store(MctsNode::UNEXPANDED, std::memory_order_release);
+        return evaluate(board, random);
+    }
+
+    // priors from the same hints the alpha-beta move ordering uses: good captures and queen promotions first
+    float weights[256];
+    float total = 0;
+    for (int i = 0; i < moves.size; i++) {
+        const Move move = moves[i];
+        const Piece victim = position.pieceOn(move.to());
+        float hint = 0;
+        if (!victim.isEmpty()) {
+            hint = Attacks::see(position, move, info) >= 0
+                       ? 1.0f + Evaluation::PieceValues[static_cast<int>(victim.type)] / 1000.0f
+                       : -0.5f;
+        }
+        if (move.promotion() != PieceType::EMPTY)
+            hint += move.promotion() == PieceType::QUEEN ? 1.5f : -1.0f;
+        weights[i] = std::exp(hint);
+        total += weights[i];
+    }
+
+    for (int i = 0; i < moves.size; i++)
+        resetNode(mNodes[first + i], moves[i], weights[i] / total);
+
+    node.childCount = static_cast<uint8_t>(moves.size);
+    node.firstChild.store(first, std::memory_order_relaxed);
+    node.state.store(MctsNode::EXPANDED, std::memory_order_release);
+    return evaluate(board, random);
+}
+
+uint32_t Mcts::selectChild(const uint32_t index) const {
+    const MctsNode &parent = mNodes[index];
+    const uint32_t first = parent.firstChild.load(std::memory_order_relaxed);
+
+    const uint32_t parentVisits = parent.visits.load(std::memory_order_relaxed);
+    const float explore = Exploration * std::sqrt(static_cast<float>(parentVisits + 1));
+    // unvisited moves start a little below the parent's own value for this side
+    const float parentValue = parentVisits ? -static_cast<float>(parent.valueSum.load(std::memory_order_relaxed))
+                                             / ValueScale / parentVisits
+                                           : 0.0f;
+    const float firstPlay = parentValue - FirstPlayReduction;
+
+    uint32_t best = first;
+    float bestScore = -1e9f;
+    for (uint32_t child = first; child < first + parent.childCount; child++) {
+        const MctsNode &node = mNodes[child];
+        const int32_t inFlight = node.virtualLoss.load(std::memory_order_relaxed);
+        const uint32_t visits = node.visits.load(std::memory_order_relaxed) + inFlight;
+        const float value = visits
+                                ? (static_cast<float>(node.valueSum.load(std::memory_order_relaxed)) / ValueScale
+                                   - inFlight) / visits
+                                : firstPlay;
+        const float score = value + explore * node.prior / (1 + visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+float Mcts::evaluate(const Board &board, uint64_t &random) const {
+    Board playing = board;
+    float sign = 1.0f;
+
+    // a few random moves, so the static evaluation lands on something less tactical
+    for (int ply = 0; ply < mLimits.playoutPlies; ply++) {
+        MoveList moves;
+        playing.getLegalMoves(moves);
+        if (moves.size == 0)
+            return playing.getPosition().isInCheck(playing.getPosition().sideToMove) ? -sign : 0.0f;
+        playing.makeMove(moves[nextRandom(random) % moves.size]);
+        sign = -sign;
+    }
+
+    return sign * std::tanh(Evaluation::evaluate(playing) / EvalScale);
+}
+
+uint32_t Mcts::findReusable(const Board &board) const {
+    const uint64_t key = board.getPosition().key;
+    if (mRootBoard.getPosition().key == key)
+        return mRoot;
+
+    const MctsNode &root = mNodes[mRoot];
+    if (root.state.load() != MctsNode::EXPANDED)
+        return MctsNode::NoChild;
+
+    // our move and the reply, or just our move when asked again for the other side
+    const uint32_t first = root.firstChild.load();
+    for (uint32_t child = first; child < first + root.childCount; child++) {
+        Board afterMove = mRootBoard;
+        afterMove.makeMove(mNodes[child].move);
+        if (afterMove.getPosition().key == key)
+            return child;
+
+        const MctsNode &node = mNodes[child];
+        if (node.state.load() != MctsNode::EXPANDED)
+            continue;
+        const uint32_t replies = node.firstChild.load();
+        for (uint32_t reply = replies; reply < replies + node.childCount; reply++) {
+            Board afterReply = afterMove;
+            afterReply.makeMove(mNodes[reply].move);
+            if (afterReply.getPosition().key == key)
+                return reply;
+        }
+    }
+    return MctsNode::NoChild;
+}
+
+void Mcts::reroot(const uint32_t index) {
+    // breadth first, so the children of every copied node stay contiguous
+    copyNode(mSpare[0], mNodes[index]);
+    uint32_t next = 1;
+    for (uint32_t i = 0; i < next; i++) {
+        MctsNode &node = mSpare[i];
+        if (node.state.load(std::memory_order_relaxed) != MctsNode::EXPANDED)
+            continue;
+
+        const uint32_t children = node.firstChild.load(std::memory_order_relaxed);
+        for (uint32_t child = 0; child < node.childCount; child++)
+            copyNode(mSpare[next + child], mNodes[children + child]);
+        node.firstChild.store(next, std::memory_order_relaxed);
+        next += node.childCount;
+    }
+
+    std::swap(mNodes, mSpare);
+    mNext = next;
+    mRoot = 0;
+}
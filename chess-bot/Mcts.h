@@ -0,0 +1,119 @@
+#ifndef CHESS_COMPETITION_MCTS_H
+#define CHESS_COMPETITION_MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "Board.h"
+#include "Move.h"
+
+struct MctsLimits {
+    std::chrono::milliseconds moveTime = std::chrono::milliseconds(1000);
+    // stop after this many playouts, for reproducible runs
+    uint64_t maxPlayouts = UINT64_MAX;
+    // zero for one per hardware thread
+    int threads = 0;
+    // random plies played out before the static evaluation, zero evaluates the leaf itself
+    int playoutPlies = 0;
+    // ends the search from another thread when set; may be null
+    const std::atomic<bool> *stop = nullptr;
+};
+
+// One node of the tree, the move leading to it and the statistics of that move.
+// Children of a node are contiguous in the pool, so a node links to them by
+// the index of the first one and their count instead of pointers.
+struct MctsNode {
+    enum State : uint8_t { UNEXPANDED, EXPANDING, EXPANDED, MATED, DRAWN };
+
+    static constexpr uint32_t NoChild = UINT32_MAX;
+
+    std::atomic<uint32_t> firstChild{NoChild};
+    std::atomic<uint8_t> state{UNEXPANDED};
+    uint8_t childCount = 0;
+    Move move;
+    // probability of the move according to the move ordering heuristics
+    float prior = 0;
+    std::atomic<uint32_t> visits{0};
+    // in-flight playouts through this node, each counted as a lost visit until it comes back
+    std::atomic<int32_t> virtualLoss{0};
+    // summed results for the side that played the move, in ValueScale units
+    std::atomic<int64_t> valueSum{0};
+};
+
+static_assert(sizeof(MctsNode) == 32, "two nodes per cache line");
+
+// Monte Carlo tree search with PUCT selection. Every thread runs playouts on
+// the same tree; virtual losses steer concurrent threads down different paths.
+// The subtree of the position reached two plies later is kept between calls.
+class Mcts {
+public:
+    // nodes of 32 bytes, so about half a gigabyte per pool
+    static constexpr uint32_t DefaultCapacity = 1 << 24;
+    static constexpr uint32_t MinCapacity = 1 << 16;
+
+    // Both pools are allocated here, so a search never pays for them. Filling a
+    // pool takes a while, see capacityFor for one that fits a move.
+    explicit Mcts(uint32_t capacity = DefaultCapacity);
+
+    // enough nodes for a search of that long on that many threads, within the bounds above
+    static uint32_t capacityFor(std::chrono::milliseconds moveTime, int threads);
+
+    uint32_t getCapacity() const { return mCapacity; }
+
+    /**
+     * @brief Run playouts from the board until the limits are reached
+     *
+     * @return Move The most visited root move, null if there are no legal moves
+     */
+    Move findBestMove(const Board &board, const MctsLimits &limits);
+
+    uint64_t getPlayouts() const { return mPlayouts; }
+    // nodes in the tree, including any kept from the previous call
+    uint32_t getTreeSize() const { return mUsed; }
+    // value of the chosen move turned back into centipawns for the side to move
+    int getScore() const { return mScore; }
+
+private:
+    static constexpr int64_t ValueScale = 1 << 16;
+    static constexpr float Exploration = 1.5f;
+    static constexpr int MaxTreeDepth = 256;
+
+    void worker(int index);
+
+    void playout(uint64_t &random);
+
+    // Adds the children of a leaf, then evaluates it. Returns the value for the side to move there.
+    float expand(uint32_t index, const Board &board, uint64_t &random);
+
+    uint32_t selectChild(uint32_t index) const;
+
+    // in [-1, 1] for the side to move
+    float evaluate(const Board &board, uint64_t &random) const;
+
+    // keeps only the subtree under `index`, copied to the front of the spare pool
+    void reroot(uint32_t index);
+
+    // finds the node of a position one or two plies below the root
+    uint32_t findReusable(const Board &board) const;
+
+    uint32_t mCapacity;
+    std::unique_ptr<MctsNode[]> mNodes;
+    std::unique_ptr<MctsNode[]> mSpare;
+    std::atomic<uint32_t> mNext{0};
+    uint32_t mUsed = 0;
+
+    uint32_t mRoot = 0;
+    Board mRootBoard;
+    bool mHasTree = false;
+
+    MctsLimits mLimits;
+    std::chrono::steady_clock::time_point mStartTime;
+    std::atomic<uint64_t> mPlayoutCount{0};
+    std::atomic<bool> mStopped{false};
+    uint64_t mPlayouts = 0;
+    int mScore = 0;
+};
+
+#endif //CHESS_COMPETITION_MCTS_H
@@ -0,0 +1,94 @@
+#ifndef CHESS_COMPETITION_MOVE_H
+#define CHESS_COMPETITION_MOVE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "Piece.h"
+
+// Squares are numbered rank * 8 + file, so a1 = 0 and h8 = 63
+constexpr uint8_t squareOf(int rank, int file) { return static_cast<uint8_t>(rank * 8 + file); }
+constexpr int rankOf(uint8_t square) { return square >> 3; }
+constexpr int fileOf(uint8_t square) { return square & 7; }
+
+// A move packed into 16 bits: from (6) | to (6) | promotion piece type (3).
+// Small enough to keep whole principal variations in fixed arrays.
+struct Move {
+    uint16_t data = 0;
+
+    constexpr Move() = default;
+
+    constexpr Move(uint8_t from, uint8_t to, PieceType promotion = PieceType::EMPTY)
+        : data(static_cast<uint16_t>(from | (to << 6) | (static_cast<uint16_t>(promotion) << 12))) {
+    }
+
+    constexpr uint8_t from() const { return data & 0x3f; }
+    constexpr uint8_t to() const { return (data >> 6) & 0x3f; }
+    constexpr PieceType promotion() const { return static_cast<PieceType>((data >> 12) & 0x7); }
+    constexpr bool isNull() const { return data == 0; }
+
+    constexpr bool operator==(const Move &other) const { return data == other.data; }
+    constexpr bool operator!=(const Move &other) const { return data != other.data; }
+
+    std::string toUci() const {
+        if (isNull())
+            return "0000";
+
+        std::string uci{
+            static_cast<char>('a' + fileOf(from())), static_cast<char>('1' + rankOf(from())),
+            static_cast<char>('a' + fileOf(to())), static_cast<char>('1' + rankOf(to()))
+        };
+        switch (promotion()) {
+            case PieceType::QUEEN: uci += 'q';
+                break;
+            case PieceType::ROOK: uci += 'r';
+                break;
+            case PieceType::BISHOP: uci += 'b';
+                break;
+            case PieceType::KNIGHT: uci += 'n';
+                break;
+            default: break;
+        }
+        return uci;
+    }
+
+    static Move fromUci(const std::string &uci) {
+        if (uci.length() < 4)
+            return {};
+
+        const uint8_t from = squareOf(uci[1] - '1', uci[0] - 'a');
+        const uint8_t to = squareOf(uci[3] - '1', uci[2] - 'a');
+        PieceType promotion = PieceType::EMPTY;
+        if (uci.length() > 4) {
+            switch (uci[4]) {
+                case 'q': promotion = PieceType::QUEEN;
+                    break;
+                case 'r': promotion = PieceType::ROOK;
+                    break;
+                case 'b': promotion = PieceType::BISHOP;
+                    break;
+                case 'n': promotion = PieceType::KNIGHT;
+                    break;
+                default: break;
+            }
+        }
+        return {from, to, promotion};
+    }
+};
+
+// Fixed capacity move list, no legal chess position has more than 218 moves
+struct MoveList {
+    std::array<Move, 256> moves;
+    int size = 0;
+
+    void push(const Move move) { moves[size++] = move; }
+    Move &operator[](const int index) { return moves[index]; }
+    const Move &operator[](const int index) const { return moves[index]; }
+    Move *begin() { return moves.data(); }
+    Move *end() { return moves.data() + size; }
+    const Move *begin() const { return moves.data(); }
+    const Move *end() const { return moves.data() + size; }
+};
+
+#endif //CHESS_COMPETITION_MOVE_H
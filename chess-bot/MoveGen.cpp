@@ -0,0 +1,178 @@
+#include "MoveGen.h"
+
+namespace {
+    template<PieceType Type>
+    void addPieceMoves(const Position &position, const AttackInfo &info, const Bitboard pieces, const Bitboard targets,
+                       MoveList &moves) {
+        const Bitboard occupancy = position.occupied();
+        const int king = position.kingSquare(position.sideToMove);
+
+        Bitboard remaining = pieces;
+        while (remaining) {
+            const int from = popLsb(remaining);
+
+            Bitboard attacks;
+            if constexpr (Type == PieceType::KNIGHT) attacks = Attacks::Knight[from];
+            else if constexpr (Type == PieceType::BISHOP) attacks = Attacks::bishop(from, occupancy);
+            else if constexpr (Type == PieceType::ROOK) attacks = Attacks::rook(from, occupancy);
+            else attacks = Attacks::queen(from, occupancy);
+
+            attacks &= targets;
+            // a pinned piece may only slide along the pin
+            if (info.pinned & squareBit(from))
+                attacks &= Attacks::Line[king][from];
+
+            while (attacks)
+                moves.push(Move(from, popLsb(attacks)));
+        }
+    }
+
+    template<int Offset>
+    void addPawnMoves(const Position &position, const AttackInfo &info, Bitboard targets, MoveList &moves) {
+        const int king = position.kingSquare(position.sideToMove);
+        while (targets) {
+            const int to = popLsb(targets);
+            const int from = to - Offset;
+            if ((info.pinned & squareBit(from)) && !(Attacks::Line[king][from] & squareBit(to)))
+                continue;
+            moves.push(Move(from, to));
+        }
+    }
+
+    template<int Offset>
+    void addPromotions(const Position &position, const AttackInfo &info, Bitboard targets, MoveList &moves) {
+        const int king = position.kingSquare(position.sideToMove);
+        while (targets) {
+            const int to = popLsb(targets);
+            const int from = to - Offset;
+            if ((info.pinned & squareBit(from)) && !(Attacks::Line[king][from] & squareBit(to)))
+                continue;
+            for (const PieceType promotion: {PieceType::QUEEN, PieceType::KNIGHT, PieceType::ROOK, PieceType::BISHOP})
+                moves.push(Move(from, to, promotion));
+        }
+    }
+
+    template<PieceColor Us, GenType Type>
+    void generatePawnMoves(const Position &position, const AttackInfo &info, const Bitboard targets,
+                           const Bitboard evasionMask, MoveList &moves) {
+        constexpr PieceColor Them = !Us;
+        constexpr int Up = Us == PieceColor::WHITE ? 8 : -8;
+        constexpr int UpLeft = Us == PieceColor::WHITE ? 7 : -9;
+        constexpr int UpRight = Us == PieceColor::WHITE ? 9 : -7;
+        // pawns about to promote, and the rank single pushes land on when a double push is possible
+        constexpr Bitboard PromotionRank = Us == PieceColor::WHITE ? Rank7Bitboard : Rank2Bitboard;
+        constexpr Bitboard DoublePushRank = Us == PieceColor::WHITE ? Rank3Bitboard : Rank6Bitboard;
+
+        const Bitboard pawns = position.pieces(Us, PieceType::PAWN);
+        const Bitboard promoting = pawns & PromotionRank;
+        const Bitboard others = pawns & ~PromotionRank;
+        const Bitboard empty = ~position.occupied();
+        const Bitboard enemies = position.pieces(Them) & targets;
+
+        if constexpr (Type != GenType::CAPTURES) {
+            const Bitboard single = shift<Up>(others) & empty;
+            const Bitboard doubled = shift<Up>(single & DoublePushRank) & empty;
+            addPawnMoves<Up>(position, info, single & targets, moves);
+            addPawnMoves<Up + Up>(position, info, doubled & targets, moves);
+        }
+
+        if constexpr (Type != GenType::QUIETS) {
+            addPawnMoves<UpLeft>(position, info, shift<UpLeft>(others) & enemies, moves);
+            addPawnMoves<UpRight>(position, info, shift<UpRight>(others) & enemies, moves);
+
+            if (promoting) {
+                // pushes onto an empty square count as captures when they promote
+                addPromotions<Up>(position, info, shift<Up>(promoting) & empty & evasionMask, moves);
+                addPromotions<UpLeft>(position, info, shift<UpLeft>(promoting) & enemies, moves);
+                addPromotions<UpRight>(position, info, shift<UpRight>(promoting) & enemies, moves);
+            }
+
+            // en passant is rare enough to simply play it out and look at the king
+            if (position.epSquare != NO_SQUARE) {
+                Bitboard capturers = Attacks::Pawn[static_cast<int>(Them)][position.epSquare] & others;
+                while (capturers) {
+                    const Move move(popLsb(capturers), position.epSquare);
+                    Position next;
+                    copyMake(next, position, move);
+                    if (!next.isInCheck(Us))
+                        moves.push(move);
+                }
+            }
+        }
+    }
+
+    template<PieceColor Us, GenType Type>
+    void generate(const Position &position, const AttackInfo &info, MoveList &moves) {
+        constexpr PieceColor Them = !Us;
+        const Bitboard ours = position.pieces(Us);
+        const Bitboard theirs = position.pieces(Them);
+        const int king = position.kingSquare(Us);
+
+        // enemy sliders see through our king in these maps, so they alone decide king moves
+        Bitboard kingTargets = Attacks::King[king] & ~ours & ~info.attacked[static_cast<int>(Them)];
+        if constexpr (Type == GenType::CAPTURES) kingTargets &= theirs;
+        else if constexpr (Type == GenType::QUIETS) kingTargets &= ~theirs;
+        while (kingTargets)
+            moves.push(Move(king, popLsb(kingTargets)));
+
+        // in double check only the king can move
+        if (popCount(info.checkers) > 1)
+            return;
+
+        // anything but the king has to capture the checker or step in between
+        const Bitboard evasionMask = info.checkers ? Attacks::Between[king][lsb(info.checkers)] | info.checkers : ~0ULL;
+
+        Bitboard targets;
+        if constexpr (Type == GenType::CAPTURES) targets = theirs;
+        else if constexpr (Type == GenType::QUIETS) targets = ~position.occupied();
+        else targets = ~ours;
+        targets &= evasionMask;
+
+        generatePawnMoves<Us, Type>(position, info, targets, evasionMask, moves);
+        addPieceMoves<PieceType::KNIGHT>(position, info, position.pieces(Us, PieceType::KNIGHT) & ~info.pinned,
+                                         targets, moves);
+        addPieceMoves<PieceType::BISHOP>(position, info, position.pieces(Us, PieceType::BISHOP), targets, moves);
+        addPieceMoves<PieceType::ROOK>(position, info, position.pieces(Us, PieceType::ROOK), targets, moves);
+        addPieceMoves<PieceType::QUEEN>(position, info, position.pieces(Us, PieceType::QUEEN), targets, moves);
+
+        if constexpr (Type == GenType::QUIETS || Type == GenType::ALL) {
+            constexpr int HomeRank = Us == PieceColor::WHITE ? 0 : 7;
+            constexpr uint8_t KingSide = Us == PieceColor::WHITE ? WHITE_KINGSIDE : BLACK_KINGSIDE;
+            constexpr uint8_t QueenSide = Us == PieceColor::WHITE ? WHITE_QUEENSIDE : BLACK_QUEENSIDE;
+            constexpr uint8_t KingFrom = squareOf(HomeRank, 4);
+
+            // the squares that must be empty, and the ones the king crosses that must not be attacked
+            constexpr Bitboard KingSideEmpty = squareBit(squareOf(HomeRank, 5)) | squareBit(squareOf(HomeRank, 6));
+            constexpr Bitboard QueenSideEmpty = squareBit(squareOf(HomeRank, 1)) | squareBit(squareOf(HomeRank, 2))
+                                                | squareBit(squareOf(HomeRank, 3));
+            constexpr Bitboard QueenSidePath = squareBit(squareOf(HomeRank, 2)) | squareBit(squareOf(HomeRank, 3));
+
+            const Bitboard occupancy = position.occupied();
+            const Bitboard enemyAttacks = info.attacked[static_cast<int>(Them)];
+            const Bitboard rooks = position.pieces(Us, PieceType::ROOK);
+            // the rights alone are not enough: a position set up by hand can hold them with the king elsewhere
+            if (!info.checkers && (position.castling & (KingSide | QueenSide)) && position.kingSquare(Us) == KingFrom) {
+                if ((position.castling & KingSide) && (rooks & squareBit(squareOf(HomeRank, 7))) &&
+                    !(occupancy & KingSideEmpty) && !(enemyAttacks & KingSideEmpty))
+                    moves.push(Move(KingFrom, squareOf(HomeRank, 6)));
+                if ((position.castling & QueenSide) && (rooks & squareBit(squareOf(HomeRank, 0))) &&
+                    !(occupancy & QueenSideEmpty) && !(enemyAttacks & QueenSidePath))
+                    moves.push(Move(KingFrom, squareOf(HomeRank, 2)));
+            }
+        }
+    }
+}
+
+template<GenType Type>
+void generateMoves(const Position &position, const AttackInfo &info, MoveList &moves) {
+    moves.size = 0;
+    if (position.sideToMove == PieceColor::WHITE)
+        generate<PieceColor::WHITE, Type>(position, info, moves);
+    else
+        generate<PieceColor::BLACK, Type>(position, info, moves);
+}
+
+template void generateMoves<GenType::CAPTURES>(const Position &, const AttackInfo &, MoveList &);
+template void generateMoves<GenType::QUIETS>(const Position &, const AttackInfo &, MoveList &);
+template void generateMoves<GenType::EVASIONS>(const Position &, const AttackInfo &, MoveList &);
+template void generateMoves<GenType::ALL>(const Position &, const AttackInfo &, MoveList &);
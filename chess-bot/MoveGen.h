@@ -0,0 +1,25 @@
+#ifndef CHESS_COMPETITION_MOVEGEN_H
+#define CHESS_COMPETITION_MOVEGEN_H
+
+#include "Attacks.h"
+#include "Move.h"
+#include "Position.h"
+
+enum class GenType : uint8_t {
+    CAPTURES, // captures, en passant and every promotion
+    QUIETS, // everything else, castling included
+    EVASIONS, // every way out of check
+    ALL
+};
+
+/**
+ * @brief Generate the legal moves of the side to move of the requested type
+ *
+ * While in check every type only returns moves that resolve the check. The
+ * generator is specialised per side and type so pawn directions, promotion
+ * ranks and target masks are all resolved at compile time.
+ */
+template<GenType Type>
+void generateMoves(const Position &position, const AttackInfo &info, MoveList &moves);
+
+#endif //CHESS_COMPETITION_MOVEGEN_H
@@ -0,0 +1,252 @@
+#include "PackedPosition.h"
+
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr uint8_t WhiteToMove = 1 << 4;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+    };
+
+    static_assert(sizeof(Header) == PackedFormat::HeaderSize, "header layout");
+
+    Header makeHeader() {
+        Header header{};
+        std::memcpy(header.magic, PackedFormat::Magic, sizeof(header.magic));
+        header.version = PackedFormat::Version;
+        header.recordSize = sizeof(PackedRecord);
+        return header;
+    }
+
+    bool isValidHeader(const Header &header) {
+        return !std::memcmp(header.magic, PackedFormat::Magic, sizeof(header.magic)) &&
+               header.version == PackedFormat::Version && header.recordSize == sizeof(PackedRecord);
+    }
+
+    uint8_t pieceCode(const Piece piece) {
+        return static_cast<uint8_t>(piece.type) | static_cast<uint8_t>(piece.color) << 3;
+    }
+}
+
+PackedPosition PackedPosition::pack(const Position &position) {
+    PackedPosition packed{};
+    packed.occupancy = position.occupied();
+    Bitboard occupancy = packed.occupancy;
+    for (int index = 0; occupancy; index++) {
+        const int square = popLsb(occupancy);
+        packed.pieces[index / 2] |= pieceCode(position.pieceOn(square)) << (index % 2 * 4);
+    }
+    packed.fullMove = position.fullMove;
+    packed.halfMove = position.halfMove;
+    packed.epSquare = position.epSquare;
+    packed.state = position.castling | (position.sideToMove == PieceColor::WHITE ? WhiteToMove : 0);
+    return packed;
+}
+
+Position PackedPosition::unpack() const {
+    Position position;
+    position.clear();
+
+    // the key is built along the way, the pieces are all there is to hash
+    uint64_t key = 0;
+    Bitboard occupancy = this->occupancy;
+    for (int index = 0; occupancy; index++) {
+        const int square = popLsb(occupancy);
+        const Bitboard bit = squareBit(square);
+        const int code = pieces[index / 2] >> (index % 2 * 4) & 0xF;
+        key ^= Zobrist::keys.pieces[code >> 3][code & 7][square];
+        position.colors[code >> 3] |= bit;
+        // kings are whatever is left of the occupancy
+        switch (static_cast<PieceType>(code & 7)) {
+            case PieceType::PAWN: position.pawns |= bit;
+                break;
+            case PieceType::KNIGHT: position.knights |= bit;
+                break;
+            case PieceType::BISHOP: position.diagonals |= bit;
+                break;
+            case PieceType::ROOK: position.orthogonals |= bit;
+                break;
+            case PieceType::QUEEN: position.diagonals |= bit;
+                position.orthogonals |= bit;
+                break;
+            default: break;
+        }
+    }
+    position.fullMove = fullMove;
+    position.halfMove = halfMove;
+    position.epSquare = epSquare;
+    position.castling = state & ALL_CASTLING;
+    position.sideToMove = state & WhiteToMove ? PieceColor::WHITE : PieceColor::BLACK;
+
+    key ^= Zobrist::keys.castling[position.castling];
+    if (epSquare != NO_SQUARE)
+        key ^= Zobrist::keys.enPassant[fileOf(epSquare)];
+    if (position.sideToMove == PieceColor::BLACK)
+        key ^= Zobrist::keys.blackToMove;
+    position.key = key;
+    return position;
+}
+
+PackedFile::~PackedFile() {
+    close();
+}
+
+bool PackedFile::isPackedFile(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    Header header;
+    const bool packed = std::fread(&header, sizeof(header), 1, file) == 1 && isValidHeader(header);
+    std::fclose(file);
+    return packed;
+}
+
+bool PackedFile::open(const std::string &path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        mError = "cannot open " + path;
+        return false;
+    }
+    LARGE_INTEGER bytes;
+    GetFileSizeEx(file, &bytes);
+    mFileHandle = file;
+    mMappedBytes = static_cast<size_t>(bytes.QuadPart);
+    if (mMappedBytes >= PackedFormat::HeaderSize) {
+        mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMappingHandle)
+            mMapping = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        mError = "cannot open " + path;
+        return false;
+    }
+    struct stat status;
+    fstat(file, &status);
+    mMappedBytes = static_cast<size_t>(status.st_size);
+    if (mMappedBytes >= PackedFormat::HeaderSize) {
+        mMapping = mmap(nullptr, mMappedBytes, PROT_READ, MAP_SHARED, file, 0);
+        if (mMapping == MAP_FAILED)
+            mMapping = nullptr;
+#ifdef MADV_SEQUENTIAL
+        // datasets are mostly streamed from front to back
+        if (mMapping)
+            madvise(mMapping, mMappedBytes, MADV_SEQUENTIAL);
+#endif
+    }
+    // the mapping keeps the file alive on its own
+    ::close(file);
+#endif
+
+    if (!mMapping) {
+        mError = path + " is too small or cannot be mapped";
+        close();
+        return false;
+    }
+    if (!isValidHeader(*static_cast<const Header *>(mMapping))) {
+        mError = path + " is not a packed file of this version";
+        close();
+        return false;
+    }
+
+    mRecords = reinterpret_cast<const PackedRecord *>(static_cast<const char *>(mMapping) + PackedFormat::HeaderSize);
+    mCount = (mMappedBytes - PackedFormat::HeaderSize) / sizeof(PackedRecord);
+    return true;
+}
+
+void PackedFile::close() {
+#ifdef _WIN32
+    if (mMapping)
+        UnmapViewOfFile(mMapping);
+    if (mMappingHandle)
+        CloseHandle(mMappingHandle);
+    if (mFileHandle)
+        CloseHandle(mFileHandle);
+    mMappingHandle = mFileHandle = nullptr;
+#else
+    if (mMapping)
+        munmap(mMapping, mMappedBytes);
+#endif
+    mMapping = nullptr;
+    mMappedBytes = 0;
+    mRecords = nullptr;
+    mCount = 0;
+}
+
+bool PackedWriter::open(const std::string &path, const bool append) {
+    close();
+
+    std::error_code error;
+    const uintmax_t bytes = std::filesystem::file_size(path, error);
+    if (append && !error && bytes > 0) {
+        mFile = std::fopen(path.c_str(), "rb");
+        Header header;
+        if (!mFile || std::fread(&header, sizeof(header), 1, mFile) != 1 || !isValidHeader(header)) {
+            mError = path + " is not a packed file of this version";
+            close();
+            return false;
+        }
+        mCount = (bytes - PackedFormat::HeaderSize) / sizeof(PackedRecord);
+        // drop the tail of a record cut short, the next write starts on a record boundary
+        std::fclose(mFile);
+        mFile = nullptr;
+        std::filesystem::resize_file(path, PackedFormat::HeaderSize + mCount * sizeof(PackedRecord), error);
+        mFile = std::fopen(path.c_str(), "ab");
+    } else {
+        error.clear();
+        mFile = std::fopen(path.c_str(), "wb");
+        const Header header = makeHeader();
+        if (mFile && std::fwrite(&header, sizeof(header), 1, mFile) != 1) {
+            std::fclose(mFile);
+            mFile = nullptr;
+        }
+        mCount = 0;
+    }
+
+    if (!mFile || error) {
+        mError = "cannot write " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool PackedWriter::write(const PackedRecord *records, const size_t count) {
+    if (!mFile)
+        return false;
+    const size_t written = std::fwrite(records, sizeof(PackedRecord), count, mFile);
+    mCount += written;
+    if (written != count)
+        mError = "write failed, the disk may be full";
+    return written == count;
+}
+
+bool PackedWriter::flush() {
+    return mFile && std::fflush(mFile) == 0;
+}
+
+void PackedWriter::close() {
+    if (mFile)
+        std::fclose(mFile);
+    mFile = nullptr;
+}
@@ -0,0 +1,137 @@
+#ifndef CHESS_COMPETITION_PACKED_POSITION_H
+#define CHESS_COMPETITION_PACKED_POSITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Bitboard.h"
+#include "Position.h"
+
+// A position in 32 bytes: the occupied squares, then a 4-bit code per
+// occupied square from a1 upwards (PieceType in the low three bits, the
+// colour in the high one, as in Piece), then the rest of the game state.
+// Decoding is a few bit scans, no text to parse.
+struct PackedPosition {
+    Bitboard occupancy;
+    // two codes per byte, the lower square in the low nibble
+    uint8_t pieces[16];
+    uint16_t fullMove;
+    uint8_t halfMove;
+    uint8_t epSquare;
+    // CastlingRights in bits 0-3, bit 4 set when white is to move
+    uint8_t state;
+    // always zero, so equal positions have equal bytes
+    uint8_t reserved[3];
+
+    static PackedPosition pack(const Position &position);
+
+    // the hash key is rebuilt while decoding
+    Position unpack() const;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+// One dataset entry: a position with what is known about it.
+struct PackedRecord {
+    PackedPosition position;
+    // search score in centipawns from white's point of view
+    int16_t score;
+    // game result from white's point of view: 2 won, 1 drawn, 0 lost
+    uint8_t result;
+    uint8_t reserved;
+    // index of the game the position comes from, to keep games apart when splitting
+    uint32_t game;
+};
+
+static_assert(sizeof(PackedRecord) == 40, "PackedRecord must stay 40 bytes");
+
+// Packed files are a 16-byte header and then the records back to back, in the
+// byte order of the machine that wrote them. The record count is the file size
+// divided by the record size, so a file cut short by a crash loses at most the
+// record being written and can be appended to again.
+namespace PackedFormat {
+    constexpr char Magic[8] = {'C', 'C', 'P', 'A', 'C', 'K', 'E', 'D'};
+    constexpr uint32_t Version = 1;
+    constexpr size_t HeaderSize = 16;
+}
+
+// Read-only view of a packed file mapped into memory. The records are used
+// straight from the mapping, the operating system pages them in on demand.
+class PackedFile {
+public:
+    PackedFile() = default;
+    ~PackedFile();
+
+    PackedFile(const PackedFile &) = delete;
+    PackedFile &operator=(const PackedFile &) = delete;
+
+    /**
+     * @brief Map a packed file
+     *
+     * @return bool False if the file cannot be opened or is not a packed file, see error()
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    size_t size() const { return mCount; }
+    const PackedRecord *begin() const { return mRecords; }
+    const PackedRecord *end() const { return mRecords + mCount; }
+    const PackedRecord &operator[](const size_t index) const { return mRecords[index]; }
+
+    const std::string &error() const { return mError; }
+
+    // whether the file starts like a packed file, without mapping it
+    static bool isPackedFile(const std::string &path);
+
+private:
+    const PackedRecord *mRecords = nullptr;
+    size_t mCount = 0;
+    void *mMapping = nullptr;
+    size_t mMappedBytes = 0;
+#ifdef _WIN32
+    void *mFileHandle = nullptr;
+    void *mMappingHandle = nullptr;
+#endif
+    std::string mError;
+};
+
+// Appends records to a packed file through the C stdio buffer.
+class PackedWriter {
+public:
+    PackedWriter() = default;
+    ~PackedWriter() { close(); }
+
+    PackedWriter(const PackedWriter &) = delete;
+    PackedWriter &operator=(const PackedWriter &) = delete;
+
+    /**
+     * @brief Create a packed file, or reopen one to append to it
+     *
+     * A partial record left at the end of an existing file is cut off.
+     *
+     * @return bool False if the file cannot be written or is not a packed file, see error()
+     */
+    bool open(const std::string &path, bool append);
+
+    bool write(const PackedRecord *records, size_t count);
+
+    // pushes buffered records to the operating system
+    bool flush();
+
+    void close();
+
+    // records in the file, including those written before it was reopened
+    size_t size() const { return mCount; }
+
+    const std::string &error() const { return mError; }
+
+private:
+    std::FILE *mFile = nullptr;
+    size_t mCount = 0;
+    std::string mError;
+};
+
+#endif //CHESS_COMPETITION_PACKED_POSITION_H
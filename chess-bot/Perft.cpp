@@ -0,0 +1,194 @@
+#include "Perft.h"
+
+#include <atomic>
+#include <memory>
+
+#include "ThreadPool.h"
+
+namespace {
+    // Subtree counts shared by all perft threads without locks. The key is stored
+    // xor the data, so an entry torn by two concurrent writers fails verification
+    // instead of returning a wrong count.
+    class PerftCache {
+    public:
+        explicit PerftCache(const size_t megabytes) {
+            size_t count = 1;
+            while (count * 2 * sizeof(Entry) <= megabytes << 20)
+                count *= 2;
+            mEntries = std::make_unique<Entry[]>(count);
+            mMask = count - 1;
+        }
+
+        bool probe(const uint64_t key, const int depth, uint64_t &nodes) const {
+            const Entry &entry = mEntries[index(key, depth)];
+            const uint64_t data = entry.data.load(std::memory_order_relaxed);
+            const uint64_t check = entry.check.load(std::memory_order_relaxed);
+            if ((check ^ data) != key || static_cast<int>(data >> DepthShift) != depth)
+                return false;
+            nodes = data & NodesMask;
+            return true;
+        }
+
+        void store(const uint64_t key, const int depth, const uint64_t nodes) {
+            Entry &entry = mEntries[index(key, depth)];
+            const uint64_t data = nodes | static_cast<uint64_t>(depth) << DepthShift;
+            entry.data.store(data, std::memory_order_relaxed);
+            entry.check.store(key ^ data, std::memory_order_relaxed);
+        }
+
+    private:
+        // the depth lives in the top byte, node counts stay far below 2^56 at any depth perft reaches
+        static constexpr int DepthShift = 56;
+        static constexpr uint64_t NodesMask = (1ULL << DepthShift) - 1;
+
+        struct Entry {
+            std::atomic<uint64_t> check{0};
+            std::atomic<uint64_t> data{0};
+        };
+
+        size_t index(const uint64_t key, const int depth) const {
+            return (key ^ depth * 0x9E3779B97F4A7C15ULL) & mMask;
+        }
+
+        std::unique_ptr<Entry[]> mEntries;
+        size_t mMask = 0;
+    };
+
+    // plies below the root that are handed out as separate tasks
+    constexpr int SplitPlies = 2;
+
+    uint64_t hashedNode(Board &board, const int depth, PerftCache *cache) {
+        MoveList moves;
+        board.getLegalMoves(moves);
+        if (depth == 1)
+            return moves.size;
+
+        const uint64_t key = board.getPosition().key;
+        uint64_t nodes = 0;
+        if (cache && cache->probe(key, depth, nodes))
+            return nodes;
+
+        for (const Move move: moves) {
+            UndoInfo undo;
+            board.makeMove(move, undo);
+            nodes += hashedNode(board, depth - 1, cache);
+            board.unmakeMove(move, undo);
+        }
+
+        if (cache)
+            cache->store(key, depth, nodes);
+        return nodes;
+    }
+
+    // count the subtree, or split it into one task per move while still close to the root
+    void splitNode(ThreadPool::Batch &batch, Board board, const int depth, const int ply, PerftCache *cache,
+                   std::atomic<uint64_t> &nodes) {
+        if (ply >= SplitPlies || depth <= 2) {
+            nodes.fetch_add(hashedNode(board, depth, cache), std::memory_order_relaxed);
+            return;
+        }
+
+        MoveList moves;
+        board.getLegalMoves(moves);
+        for (const Move move: moves) {
+            Board child = board;
+            child.makeMove(move);
+            batch.submit([&batch, child, depth, ply, cache, &nodes] {
+                splitNode(batch, child, depth - 1, ply + 1, cache, nodes);
+            });
+        }
+    }
+
+    // stack[0] is the current node and stack[1] is overwritten with each child
+    uint64_t copyMakeNode(Board *stack, const int depth) {
+        MoveList moves;
+        stack[0].getLegalMoves(moves);
+        if (depth == 1)
+            return moves.size;
+
+        uint64_t nodes = 0;
+        for (const Move move: moves) {
+            stack[1].copyMake(stack[0], move);
+            nodes += copyMakeNode(stack + 1, depth - 1);
+        }
+        return nodes;
+    }
+}
+
+uint64_t Perft::perft(Board &board, const int depth) {
+    if (depth == 0)
+        return 1;
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    if (depth == 1)
+        return moves.size;
+
+    uint64_t nodes = 0;
+    for (const Move move: moves) {
+        UndoInfo undo;
+        board.makeMove(move, undo);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(move, undo);
+    }
+    return nodes;
+}
+
+uint64_t Perft::perftCopyMake(const Board &board, const int depth) {
+    if (depth == 0)
+        return 1;
+
+    // one board per ply, allocated once for the whole run
+    std::vector<Board> stack(depth + 1, board);
+    return copyMakeNode(stack.data(), depth);
+}
+
+std::vector<Perft::DivideEntry> Perft::divide(const Board &board, const int depth, const int threads,
+                                             const size_t hashMegabytes) {
+    std::vector<DivideEntry> entries;
+    if (depth <= 0)
+        return entries;
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+
+    std::unique_ptr<PerftCache> cache;
+    if (hashMegabytes > 0)
+        cache = std::make_unique<PerftCache>(hashMegabytes);
+
+    // one counter per root move, the pool adds up the subtrees below each
+    std::vector<std::atomic<uint64_t>> counts(moves.size);
+    {
+        // an explicit thread count gets a pool of its own, otherwise the persistent one is used
+        std::unique_ptr<ThreadPool> ownPool;
+        if (threads > 0)
+            ownPool = std::make_unique<ThreadPool>(threads);
+        ThreadPool::Batch batch(ownPool ? *ownPool : ThreadPool::shared());
+        for (int i = 0; i < moves.size; i++) {
+            Board child = board;
+            child.makeMove(moves[i]);
+            if (depth == 1) {
+                counts[i] = 1;
+                continue;
+            }
+            batch.submit([&batch, &counts, &cache, child, depth, i] {
+                splitNode(batch, child, depth - 1, 1, cache.get(), counts[i]);
+            });
+        }
+        batch.wait();
+    }
+
+    for (int i = 0; i < moves.size; i++)
+        entries.push_back({moves[i], counts[i].load()});
+    return entries;
+}
+
+uint64_t Perft::perftParallel(const Board &board, const int depth, const int threads, const size_t hashMegabytes) {
+    if (depth <= 0)
+        return 1;
+
+    uint64_t nodes = 0;
+    for (const DivideEntry &entry: divide(board, depth, threads, hashMegabytes))
+        nodes += entry.nodes;
+    return nodes;
+}
@@ -0,0 +1,38 @@
+#ifndef CHESS_COMPETITION_PERFT_H
+#define CHESS_COMPETITION_PERFT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Board.h"
+
+namespace Perft {
+    /**
+     * @brief Count the leaf nodes of the legal move tree, playing and taking back moves on one board
+     */
+    uint64_t perft(Board &board, int depth);
+
+    /**
+     * @brief Same count as perft, but every child is a memcpy of its parent with the move played
+     */
+    uint64_t perftCopyMake(const Board &board, int depth);
+
+    struct DivideEntry {
+        Move move;
+        uint64_t nodes;
+    };
+
+    /**
+     * @brief Leaf counts below every root move, the subtrees spread over a work-stealing thread pool
+     *
+     * @param threads Workers to use, zero for the shared pool
+     * @param hashMegabytes Size of a cache of subtree counts keyed by position and depth, none when zero
+     */
+    std::vector<DivideEntry> divide(const Board &board, int depth, int threads = 0, size_t hashMegabytes = 0);
+
+    // The total of divide
+    uint64_t perftParallel(const Board &board, int depth, int threads = 0, size_t hashMegabytes = 0);
+} // namespace Perft
+
+#endif //CHESS_COMPETITION_PERFT_H
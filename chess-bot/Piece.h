@@ -0,0 +1,62 @@
+#ifndef CHESS_COMPETITION_PIECE_H
+#define CHESS_COMPETITION_PIECE_H
+
+#include <cctype>
+#include <cstdint>
+
+enum class PieceType: uint8_t {
+    EMPTY = 0b000,
+    PAWN = 0b001,
+    KNIGHT = 0b010,
+    BISHOP = 0b011,
+    ROOK = 0b100,
+    QUEEN = 0b101,
+    KING = 0b110
+};
+
+enum class PieceColor: uint8_t {
+    BLACK = 0b0,
+    WHITE = 0b1
+};
+
+constexpr PieceColor operator!(PieceColor color) {
+    return color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+struct Piece {
+    PieceType type: 3;
+    PieceColor color: 1;
+
+    Piece() : type(PieceType::EMPTY), color(PieceColor::WHITE) {
+    }
+
+    Piece(PieceType type, PieceColor color) : type(type), color(color) {
+    }
+
+    bool isEmpty() const { return type == PieceType::EMPTY; }
+
+    char toChar() const {
+        if (isEmpty()) return '.';
+
+        char c;
+        switch (type) {
+            case PieceType::PAWN: c = 'p';
+                break;
+            case PieceType::KNIGHT: c = 'n';
+                break;
+            case PieceType::BISHOP: c = 'b';
+                break;
+            case PieceType::ROOK: c = 'r';
+                break;
+            case PieceType::QUEEN: c = 'q';
+                break;
+            case PieceType::KING: c = 'k';
+                break;
+            default: return '.';
+        }
+
+        return (color == PieceColor::WHITE) ? toupper(c) : c;
+    }
+};
+
+#endif //CHESS_COMPETITION_PIECE_H
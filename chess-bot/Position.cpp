@@ -0,0 +1,241 @@
+#include "Position.h"
+
+#include "Attacks.h"
+
+namespace {
+    // castling rights that survive a move touching the square
+    constexpr auto CastlingMasks = [] {
+        std::array<uint8_t, 64> masks{};
+        masks.fill(ALL_CASTLING);
+        masks[squareOf(0, 4)] &= ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+        masks[squareOf(0, 0)] &= ~WHITE_QUEENSIDE;
+        masks[squareOf(0, 7)] &= ~WHITE_KINGSIDE;
+        masks[squareOf(7, 4)] &= ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+        masks[squareOf(7, 0)] &= ~BLACK_QUEENSIDE;
+        masks[squareOf(7, 7)] &= ~BLACK_KINGSIDE;
+        return masks;
+    }();
+}
+
+void Position::clear() {
+    std::memset(this, 0, sizeof(Position));
+    fullMove = 1;
+    epSquare = NO_SQUARE;
+    castling = NO_CASTLING;
+    sideToMove = PieceColor::WHITE;
+    computeKey();
+}
+
+Bitboard Position::pieces(const PieceType type) const {
+    switch (type) {
+        case PieceType::PAWN: return pawns;
+        case PieceType::KNIGHT: return knights;
+        case PieceType::BISHOP: return diagonals & ~orthogonals;
+        case PieceType::ROOK: return orthogonals & ~diagonals;
+        case PieceType::QUEEN: return diagonals & orthogonals;
+        case PieceType::KING: return kings();
+        default: return 0;
+    }
+}
+
+Piece Position::pieceOn(const uint8_t square) const {
+    const Bitboard bit = squareBit(square);
+    if (!(occupied() & bit))
+        return Piece();
+
+    const PieceColor color = (colors[static_cast<int>(PieceColor::WHITE)] & bit) ? PieceColor::WHITE : PieceColor::BLACK;
+    if (pawns & bit) return Piece(PieceType::PAWN, color);
+    if (knights & bit) return Piece(PieceType::KNIGHT, color);
+    if (diagonals & bit) return Piece((orthogonals & bit) ? PieceType::QUEEN : PieceType::BISHOP, color);
+    if (orthogonals & bit) return Piece(PieceType::ROOK, color);
+    return Piece(PieceType::KING, color);
+}
+
+void Position::setBits(const Piece piece, const uint8_t square) {
+    const Bitboard bit = squareBit(square);
+    colors[static_cast<int>(piece.color)] |= bit;
+    switch (piece.type) {
+        case PieceType::PAWN: pawns |= bit;
+            break;
+        case PieceType::KNIGHT: knights |= bit;
+            break;
+        case PieceType::BISHOP: diagonals |= bit;
+            break;
+        case PieceType::ROOK: orthogonals |= bit;
+            break;
+        case PieceType::QUEEN: diagonals |= bit;
+            orthogonals |= bit;
+            break;
+        default: break;
+    }
+}
+
+void Position::clearBits(const uint8_t square) {
+    const Bitboard keep = ~squareBit(square);
+    colors[0] &= keep;
+    colors[1] &= keep;
+    pawns &= keep;
+    knights &= keep;
+    diagonals &= keep;
+    orthogonals &= keep;
+}
+
+void Position::put(const Piece piece, const uint8_t square) {
+    if (!pieceOn(square).isEmpty())
+        remove(square);
+    if (piece.isEmpty())
+        return;
+
+    setBits(piece, square);
+    key ^= Zobrist::pieceKey(piece, square);
+}
+
+void Position::remove(const uint8_t square) {
+    const Piece piece = pieceOn(square);
+    if (piece.isEmpty())
+        return;
+
+    clearBits(square);
+    key ^= Zobrist::pieceKey(piece, square);
+}
+
+void Position::computeKey() {
+    key = Zobrist::keys.castling[castling];
+    if (epSquare != NO_SQUARE)
+        key ^= Zobrist::keys.enPassant[fileOf(epSquare)];
+    if (sideToMove == PieceColor::BLACK)
+        key ^= Zobrist::keys.blackToMove;
+
+    Bitboard occupancy = occupied();
+    while (occupancy) {
+        const int square = popLsb(occupancy);
+        key ^= Zobrist::pieceKey(pieceOn(square), square);
+    }
+}
+
+bool Position::isSquareAttacked(const uint8_t square, const PieceColor attacker) const {
+    const Bitboard them = pieces(attacker);
+    const Bitboard occupancy = occupied();
+
+    // a pawn of the other colour on the square attacks exactly the squares our pawns would attack it from
+    return (Attacks::Pawn[static_cast<int>(!attacker)][square] & pawns & them)
+           || (Attacks::Knight[square] & knights & them)
+           || (Attacks::King[square] & kings() & them)
+           || (Attacks::bishop(square, occupancy) & diagonals & them)
+           || (Attacks::rook(square, occupancy) & orthogonals & them);
+}
+
+uint64_t Position::keyAfter(const Move move) const {
+    const Piece moving = pieceOn(move.from());
+    const Piece captured = pieceOn(move.to());
+    const Piece placed = move.promotion() != PieceType::EMPTY ? Piece(move.promotion(), moving.color) : moving;
+
+    uint64_t next = key ^ Zobrist::keys.blackToMove ^ Zobrist::pieceKey(moving, move.from())
+                    ^ Zobrist::pieceKey(placed, move.to());
+    if (!captured.isEmpty())
+        next ^= Zobrist::pieceKey(captured, move.to());
+    if (epSquare != NO_SQUARE)
+        next ^= Zobrist::keys.enPassant[fileOf(epSquare)];
+    return next;
+}
+
+Piece Position::doMove(const Move move) {
+    const uint8_t from = move.from(), to = move.to();
+    const PieceColor us = sideToMove;
+    const Piece moving = pieceOn(from);
+    Piece captured = pieceOn(to);
+
+    if (epSquare != NO_SQUARE)
+        key ^= Zobrist::keys.enPassant[fileOf(epSquare)];
+    const uint8_t previousEpSquare = epSquare;
+    epSquare = NO_SQUARE;
+
+    halfMove++;
+    if (!captured.isEmpty()) {
+        remove(to);
+        halfMove = 0;
+    }
+
+    remove(from);
+    put(move.promotion() != PieceType::EMPTY ? Piece(move.promotion(), us) : moving, to);
+
+    if (moving.type == PieceType::PAWN) {
+        halfMove = 0;
+        const int forward = us == PieceColor::WHITE ? 8 : -8;
+
+        if (to == previousEpSquare) {
+            // en passant, the captured pawn sits behind the target square
+            captured = pieceOn(to - forward);
+            remove(to - forward);
+        } else if (to - from == 2 * forward) {
+            // only record the en passant square when an enemy pawn can actually take,
+            // otherwise transpositions would hash differently
+            const Bitboard adjacent = ((squareBit(to) << 1) & ~FileABitboard) | ((squareBit(to) >> 1) & ~FileHBitboard);
+            if (adjacent & pawns & pieces(!us)) {
+                epSquare = from + forward;
+                key ^= Zobrist::keys.enPassant[fileOf(epSquare)];
+            }
+        }
+    } else if (moving.type == PieceType::KING && (to == from + 2 || to + 2 == from)) {
+        // castling, bring the rook to the other side of the king
+        const bool kingSide = to > from;
+        const uint8_t rookFrom = kingSide ? from + 3 : from - 4;
+        const uint8_t rookTo = kingSide ? from + 1 : from - 1;
+        remove(rookFrom);
+        put(Piece(PieceType::ROOK, us), rookTo);
+    }
+
+    key ^= Zobrist::keys.castling[castling];
+    castling &= CastlingMasks[from] & CastlingMasks[to];
+    key ^= Zobrist::keys.castling[castling];
+
+    if (us == PieceColor::BLACK)
+        fullMove++;
+    sideToMove = !us;
+    key ^= Zobrist::keys.blackToMove;
+
+    return captured;
+}
+
+void Position::makeMove(const Move move) {
+    doMove(move);
+}
+
+void Position::makeMove(const Move move, UndoInfo &undo) {
+    undo.key = key;
+    undo.castling = castling;
+    undo.epSquare = epSquare;
+    undo.halfMove = halfMove;
+    undo.captured = doMove(move);
+}
+
+void Position::unmakeMove(const Move move, const UndoInfo &undo) {
+    const uint8_t from = move.from(), to = move.to();
+    const PieceColor us = !sideToMove;
+    Piece moving = pieceOn(to);
+    if (move.promotion() != PieceType::EMPTY)
+        moving.type = PieceType::PAWN;
+
+    // bits only, the key is restored wholesale at the end
+    clearBits(to);
+    setBits(moving, from);
+
+    if (moving.type == PieceType::KING && (to == from + 2 || to + 2 == from)) {
+        const bool kingSide = to > from;
+        clearBits(kingSide ? from + 1 : from - 1);
+        setBits(Piece(PieceType::ROOK, us), kingSide ? from + 3 : from - 4);
+    }
+
+    if (!undo.captured.isEmpty()) {
+        const bool enPassant = moving.type == PieceType::PAWN && to == undo.epSquare;
+        setBits(undo.captured, enPassant ? (us == PieceColor::WHITE ? to - 8 : to + 8) : to);
+    }
+
+    if (us == PieceColor::BLACK)
+        fullMove--;
+    sideToMove = us;
+    castling = undo.castling;
+    epSquare = undo.epSquare;
+    halfMove = undo.halfMove;
+    key = undo.key;
+}
@@ -0,0 +1,104 @@
+#ifndef CHESS_COMPETITION_POSITION_H
+#define CHESS_COMPETITION_POSITION_H
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "Bitboard.h"
+#include "Move.h"
+#include "Piece.h"
+#include "Zobrist.h"
+
+enum CastlingRights : uint8_t {
+    NO_CASTLING = 0,
+    WHITE_KINGSIDE = 0b0001,
+    WHITE_QUEENSIDE = 0b0010,
+    BLACK_KINGSIDE = 0b0100,
+    BLACK_QUEENSIDE = 0b1000,
+    ALL_CASTLING = 0b1111
+};
+
+constexpr uint8_t NO_SQUARE = 64;
+
+// Everything needed to take a move back with unmakeMove
+struct UndoInfo {
+    uint64_t key;
+    Piece captured;
+    uint8_t castling;
+    uint8_t epSquare;
+    uint8_t halfMove;
+};
+
+// The complete game state in a single cache line. Queens live on both slider
+// sets and kings are whatever is left of the occupancy, which is what keeps
+// the layout at 64 bytes. Being trivially copyable, copy-make is a memcpy and
+// forking the state for another search thread is free.
+struct alignas(64) Position {
+    Bitboard colors[2]; // indexed by PieceColor
+    Bitboard pawns;
+    Bitboard knights;
+    Bitboard diagonals; // bishops and queens
+    Bitboard orthogonals; // rooks and queens
+    uint64_t key;
+    uint16_t fullMove;
+    uint8_t halfMove;
+    uint8_t epSquare; // NO_SQUARE when there is no en passant capture available
+    uint8_t castling: 4; // CastlingRights mask
+    PieceColor sideToMove: 1;
+
+    // Empty board, white to move, no castling rights
+    void clear();
+
+    Bitboard occupied() const { return colors[0] | colors[1]; }
+    Bitboard pieces(const PieceColor color) const { return colors[static_cast<int>(color)]; }
+    Bitboard kings() const { return occupied() & ~(pawns | knights | diagonals | orthogonals); }
+    Bitboard pieces(PieceType type) const;
+    Bitboard pieces(const PieceColor color, const PieceType type) const { return pieces(color) & pieces(type); }
+
+    uint8_t kingSquare(const PieceColor color) const { return lsb(pieces(color) & kings()); }
+
+    Piece pieceOn(uint8_t square) const;
+
+    // Place or remove a piece, keeping the hash key in sync
+    void put(Piece piece, uint8_t square);
+
+    void remove(uint8_t square);
+
+    // Recompute the hash key from scratch, used after setting up a position
+    void computeKey();
+
+    bool isSquareAttacked(uint8_t square, PieceColor attacker) const;
+
+    bool isInCheck(const PieceColor color) const { return isSquareAttacked(kingSquare(color), !color); }
+
+    // The key after a move, cheap enough to compute before making it. Castling
+    // rights and a new en passant square are left out, so it is only good as a
+    // hint for prefetching the hash table.
+    uint64_t keyAfter(Move move) const;
+
+    // Play a move in place. No legality checks are made.
+    void makeMove(Move move);
+
+    void makeMove(Move move, UndoInfo &undo);
+
+    void unmakeMove(Move move, const UndoInfo &undo);
+
+private:
+    void setBits(Piece piece, uint8_t square);
+
+    void clearBits(uint8_t square);
+
+    Piece doMove(Move move);
+};
+
+static_assert(sizeof(Position) == 64, "Position must fit in a single cache line");
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be copyable with memcpy");
+
+// Copy-make: clone the parent with a plain memcpy and play the move on the clone
+inline void copyMake(Position &child, const Position &parent, const Move move) {
+    std::memcpy(&child, &parent, sizeof(Position));
+    child.makeMove(move);
+}
+
+#endif //CHESS_COMPETITION_POSITION_H
@@ -0,0 +1,558 @@
+#include "Search.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include "Evaluation.h"
+#include "ThreadPool.h"
+
+namespace {
+    // move ordering buckets, the previous principal variation is tried first
+    constexpr int PvMoveScore = 1'000'000;
+    constexpr int HashMoveScore = PvMoveScore - 1;
+    constexpr int CaptureScore = 100'000;
+    constexpr int KillerScore = 90'000;
+
+    // bring the best remaining move to position `index`
+    void pickMove(MoveList &moves, int (&scores)[256], const int index) {
+        int best = index;
+        for (int i = index + 1; i < moves.size; i++) {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+        std::swap(moves[index], moves[best]);
+        std::swap(scores[index], scores[best]);
+    }
+
+    // mate scores are stored relative to the node instead of the root, so they stay right when reached at another ply
+    int scoreToTable(const int score, const int ply) {
+        if (score >= MATE_BOUND) return score + ply;
+        if (score <= -MATE_BOUND) return score - ply;
+        return score;
+    }
+
+    int scoreFromTable(const int score, const int ply) {
+        if (score >= MATE_BOUND) return score - ply;
+        if (score <= -MATE_BOUND) return score + ply;
+        return score;
+    }
+
+    bool isCapture(const Board &board, const Move move) {
+        return !board.getPiece(rankOf(move.to()), fileOf(move.to())).isEmpty();
+    }
+}
+
+Search::Search(const size_t hashMegabytes)
+    : mOwnedTable(std::make_unique<TranspositionTable>(hashMegabytes)), mTable(mOwnedTable.get()) {
+}
+
+Search::Search(Search &main) : mTable(main.mTable), mMain(&main) {
+}
+
+Search::~Search() = default;
+
+void Search::newGame() {
+    mTable->clear();
+}
+
+Move Search::findBestMove(const Board &board, const SearchLimits &limits) {
+    mLimits = limits;
+    mStartTime = std::chrono::steady_clock::now();
+    mSharedNodes = 0;
+    mStopped = false;
+    mTable->newSearch();
+    mMateFound = false;
+    mCandidate = 0;
+    mUnsafeCount = 0;
+    mUnsafeApplied = 0;
+    mRestart = false;
+
+    // helpers are kept between searches, so only a growing thread count allocates
+    const size_t helperCount = std::max(limits.threads, 1) - 1;
+    while (mHelpers.size() < helperCount)
+        mHelpers.emplace_back(new Search(*this));
+
+    // helpers run on the persistent pool, starting them wakes parked workers instead of creating threads
+    ThreadPool::Batch helpers(ThreadPool::shared());
+    for (size_t i = 0; i < helperCount; i++) {
+        Search *helper = mHelpers[i].get();
+        helper->mLimits = limits;
+        helper->mStartTime = mStartTime;
+        helper->mStopped = false;
+        // every other helper starts a ply deeper, so the threads spread over more iterations
+        helpers.submit([this, helper, &board, i] {
+            // a worker that only gets to it after the search has no use for it
+            if (!mStopped)
+                helper->iterate(board, 1 + static_cast<int>(i % 2 == 0));
+        });
+    }
+
+    // a core the search leaves idle goes to the mate solver
+    const bool mateSolver = limits.mateSolver && limits.multiPv <= 1 && limits.searchMoves.size == 0 &&
+                            ThreadPool::shared().size() > static_cast<int>(helperCount) + 1;
+    if (mateSolver) {
+        if (!mMateSolver)
+            mMateSolver = std::make_unique<MateSolver>();
+        helpers.submit([this, &board] { solveMates(board); });
+    }
+
+    iterate(board, 1);
+
+    // the helpers only stop once the main search is done
+    mStopped = true;
+    helpers.wait();
+
+    const int mateScore = mMateFound ? MATE_SCORE - (2 * mMateSolver->getMateMoves() - 1) : 0;
+    if (mMateFound && !mMateSolver->getLine().empty() && (mateScore > mRootScore || mRootPv.length() == 0)) {
+        mRootPv.assign(mMateSolver->getLine());
+        mRootScore = mateScore;
+        mLines[0].pv = mRootPv;
+        mLines[0].score = mateScore;
+    }
+
+    return mRootPv.bestMove();
+}
+
+void Search::iterate(const Board &board, const int firstDepth) {
+    mNodes = 0;
+    mFlushedNodes = 0;
+    mRootPv = PvTable();
+    mRootScore = 0;
+    mRootDepth = 0;
+    for (auto &entry: mStack)
+        entry.killers[0] = entry.killers[1] = Move();
+
+    Board root = board;
+    mHistory.clear();
+    mHistory.push(root.getPosition().key);
+
+    // the root moves of searchmoves that are legal, all of them when there are none
+    root.getLegalMoves(mRootMoves);
+    const int legalCount = mRootMoves.size;
+    int kept = 0;
+    for (const Move move: mRootMoves) {
+        if (std::find(mLimits.searchMoves.begin(), mLimits.searchMoves.end(), move) != mLimits.searchMoves.end())
+            mRootMoves[kept++] = move;
+    }
+    if (kept > 0)
+        mRootMoves.size = kept;
+    mRestricted = mRootMoves.size < legalCount;
+
+    // resized in place, so a search with the same number of lines does not allocate
+    const int lineCount = std::clamp(mLimits.multiPv, 1, std::max(mRootMoves.size, 1));
+    mLines.resize(lineCount);
+    mNextLines.resize(lineCount);
+    std::fill(mLines.begin(), mLines.end(), SearchLine());
+
+    for (int depth = firstDepth; depth <= mLimits.maxDepth && depth < MAX_PLY; depth++) {
+        if (!mMain) {
+            excludeUnsafeMoves();
+            // the move to fall back on left the root: start over without it, the first
+            // iteration always completes and the table soon brings the search back to depth
+            mRestart = false;
+            if (!mRootPv.bestMove().isNull() &&
+                std::find(mRootMoves.begin(), mRootMoves.end(), mRootPv.bestMove()) == mRootMoves.end()) {
+                mRootPv = PvTable();
+                mRootScore = 0;
+                mRootDepth = 0;
+                std::fill(mLines.begin(), mLines.end(), SearchLine());
+                depth = 1;
+            }
+        }
+
+        // each line searches the root without the first moves of the lines before it
+        for (mPvIndex = 0; mPvIndex < lineCount; mPvIndex++) {
+            mFollowLine = &mLines[mPvIndex].pv;
+            mFollowPv = true;
+            const int score = aspirationWindow(root, depth, mLines[mPvIndex].score);
+            if (aborted())
+                break;
+
+            mNextLines[mPvIndex].pv = mPvTable;
+            mNextLines[mPvIndex].score = score;
+            for (int i = mPvIndex; i > 0 && mNextLines[i].score > mNextLines[i - 1].score; i--)
+                std::swap(mNextLines[i], mNextLines[i - 1]);
+        }
+        if (mRestart && !mStopped) {
+            depth--;
+            continue;
+        }
+        if (mStopped)
+            break;
+
+        std::swap(mLines, mNextLines);
+        mRootPv = mLines[0].pv;
+        mRootScore = mLines[0].score;
+        mRootDepth = depth;
+        if (!mMain)
+            mCandidate.store(mRootPv.bestMove().data, std::memory_order_relaxed);
+
+        if (mInfoCallback) {
+            flushNodes();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - mStartTime);
+            for (int line = 0; line < lineCount; line++)
+                mInfoCallback(SearchInfo{depth, mLines[line].score, mSharedNodes, elapsed, mLines[line].pv, line + 1});
+        }
+
+        // no legal moves at the root, or a forced mate was found and there are no other lines to finish
+        if (mRootPv.length() == 0 || (lineCount == 1 && std::abs(mRootScore) >= MATE_BOUND))
+            break;
+    }
+
+    flushNodes();
+}
+
+void Search::flushNodes() {
+    std::atomic<uint64_t> &total = mMain ? mMain->mSharedNodes : mSharedNodes;
+    total.fetch_add(mNodes - mFlushedNodes, std::memory_order_relaxed);
+    mFlushedNodes = mNodes;
+}
+
+void Search::solveMates(const Board &board) {
+    MateLimits limits;
+    limits.maxMoves = MateSolverMoves;
+    // the mates alpha-beta is slow to see are long series of checks
+    limits.checksOnly = true;
+    limits.stop = &mStopped;
+    // half of the time for our own mates, the rest for the moves the search wants to play
+    if (mLimits.moveTime != std::chrono::milliseconds::max())
+        limits.moveTime = mLimits.moveTime / 2;
+    if (mMateSolver->solve(board, limits) == MateStatus::PROVEN) {
+        mMateFound = true;
+        mStopped = true;
+        return;
+    }
+
+    limits.moveTime = std::chrono::milliseconds::max();
+    limits.maxNodes = SafetyCheckNodes;
+    Move checked;
+    while (!mStopped.load(std::memory_order_relaxed)) {
+        Move candidate;
+        candidate.data = mCandidate.load(std::memory_order_relaxed);
+        if (candidate.isNull() || candidate == checked) {
+            // a new candidate comes at most once per iteration
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        checked = candidate;
+
+        Board reply = board;
+        reply.makeMove(candidate);
+        if (mMateSolver->solve(reply, limits) == MateStatus::PROVEN)
+            refute(candidate);
+    }
+}
+
+void Search::refute(const Move move) {
+    // written under the lock, read without it up to the published count
+    std::lock_guard lock(mUnsafeMutex);
+    const int count = mUnsafeCount.load(std::memory_order_relaxed);
+    if (count < 256) {
+        mUnsafeMoves[count] = move;
+        mUnsafeCount.store(count + 1, std::memory_order_release);
+    }
+}
+
+void Search::excludeUnsafeMoves() {
+    const int count = mUnsafeCount.load(std::memory_order_acquire);
+    for (; mUnsafeApplied < count; mUnsafeApplied++) {
+        Move *move = std::find(mRootMoves.begin(), mRootMoves.end(), mUnsafeMoves[mUnsafeApplied]);
+        if (move == mRootMoves.end() || mRootMoves.size == 1)
+            continue;
+        *move = mRootMoves[mRootMoves.size - 1];
+        mRootMoves.size--;
+        mRestricted = true;
+    }
+}
+
+bool Search::isUnsafe(const Move move) const {
+    const Move *end = mUnsafeMoves + mUnsafeCount.load(std::memory_order_acquire);
+    return !move.isNull() && std::find(mUnsafeMoves, end, move) != end;
+}
+
+int Search::aspirationWindow(Board &board, const int depth, const int previousScore) {
+    int delta = AspirationDelta;
+    int alpha = -INFINITE_SCORE;
+    int beta = INFINITE_SCORE;
+
+    // shallow iterations are too unstable for a narrow window to pay off
+    if (depth >= AspirationMinDepth) {
+        alpha = std::max(previousScore - delta, -INFINITE_SCORE);
+        beta = std::min(previousScore + delta, INFINITE_SCORE);
+    }
+
+    while (true) {
+        const int score = pvSearch(board, depth, 0, alpha, beta);
+        if (aborted())
+            return score;
+
+        if (score <= alpha) {
+            // fail low, pull beta in as well since the true score is below the old window
+            beta = (alpha + beta) / 2;
+            alpha = std::max(score - delta, -INFINITE_SCORE);
+        } else if (score >= beta) {
+            beta = std::min(score + delta, INFINITE_SCORE);
+        } else {
+            return score;
+        }
+
+        delta += delta;
+        mFollowPv = true;
+    }
+}
+
+int Search::pvSearch(Board &board, const int depth, const int ply, int alpha, const int beta) {
+    mPvTable.clear(ply);
+
+    if (depth <= 0 || ply >= MAX_PLY - 1)
+        return quiescence(board, ply, alpha, beta);
+
+    mNodes++;
+    if (shouldStop())
+        return 0;
+
+    const Position &position = board.getPosition();
+    if (ply > 0) {
+        if (mHistory.isRepetition(position.halfMove))
+            return 0;
+
+        // a single move can repeat an earlier position, so we can always get a draw here
+        if (alpha < 0 && mHistory.hasUpcomingRepetition(position, ply)) {
+            alpha = 0;
+            if (alpha >= beta)
+                return alpha;
+        }
+    }
+
+    const bool pvNode = beta - alpha > 1;
+
+    TTEntry entry;
+    const bool hit = mTable->probe(position.key, entry);
+    const Move hashMove = hit ? entry.move : Move();
+    if (hit && !pvNode && ply > 0 && entry.depth >= depth) {
+        const int score = scoreFromTable(entry.score, ply);
+        if (entry.bound() == Bound::EXACT || (entry.bound() == Bound::LOWER && score >= beta) ||
+            (entry.bound() == Bound::UPPER && score <= alpha))
+            return score;
+    }
+
+    // one set of attack maps per node, shared by move generation and ordering
+    AttackInfo info;
+    info.compute(position);
+    const bool inCheck = info.checkers != 0;
+
+    SearchStackEntry &stack = mStack[ply];
+    MoveList &moves = stack.moves;
+    board.getLegalMoves(moves, info);
+    if (moves.size == 0)
+        return inCheck ? -MATE_SCORE + ply : 0;
+
+    // fifty moves without a capture or pawn move, checkmate still takes precedence
+    if (ply > 0 && position.halfMove >= 100)
+        return 0;
+
+    // searchmoves and the lines already found this iteration take moves out of the root
+    const bool filtered = ply == 0 && (mRestricted || mPvIndex > 0);
+    if (filtered) {
+        int kept = 0;
+        for (const Move move: moves) {
+            bool excluded = std::find(mRootMoves.begin(), mRootMoves.end(), move) == mRootMoves.end();
+            for (int line = 0; line < mPvIndex && !excluded; line++)
+                excluded = mNextLines[line].pv.bestMove() == move;
+            if (!excluded)
+                moves[kept++] = move;
+        }
+        moves.size = kept;
+    }
+
+    // leaving the previous principal variation, stop boosting its moves
+    if (mFollowPv && (ply >= mFollowLine->length() ||
+                      std::find(moves.begin(), moves.end(), (*mFollowLine)[ply]) == moves.end()))
+        mFollowPv = false;
+
+    scoreMoves(board, info, ply, hashMove);
+
+    const int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove;
+    for (int i = 0; i < moves.size; i++) {
+        pickMove(moves, stack.scores, i);
+        const Move move = moves[i];
+        const bool capture = isCapture(board, move);
+
+        // get the child's bucket on its way from memory while the move is made
+        mTable->prefetch(position.keyAfter(move));
+        Board child = board;
+        child.makeMove(move);
+        mHistory.push(child.getPosition().key);
+
+        int score;
+        if (i == 0) {
+            score = -pvSearch(child, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // scout with a null window, only re-search when the move might beat alpha
+            score = -pvSearch(child, depth - 1, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta && pvNode)
+                score = -pvSearch(child, depth - 1, ply + 1, -beta, -alpha);
+        }
+        mHistory.pop();
+
+        if (aborted())
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+                mPvTable.update(ply, move);
+                if (score >= beta) {
+                    if (!capture)
+                        storeKiller(ply, move);
+                    break;
+                }
+            }
+        }
+    }
+
+    // a score over only some of the root moves is no score of the position
+    if (!filtered) {
+        const Bound bound = bestScore >= beta ? Bound::LOWER : bestScore > originalAlpha ? Bound::EXACT : Bound::UPPER;
+        mTable->store(position.key, bestMove, scoreToTable(bestScore, ply), depth, bound);
+    }
+
+    return bestScore;
+}
+
+int Search::quiescence(Board &board, const int ply, int alpha, const int beta) {
+    mPvTable.clear(ply);
+    mFollowPv = false;
+    mNodes++;
+    if (shouldStop())
+        return 0;
+
+    AttackInfo info;
+    info.compute(board.getPosition());
+
+    SearchStackEntry &stack = mStack[ply];
+    MoveList &tactical = stack.moves;
+    int bestScore;
+    if (info.checkers) {
+        // standing pat is no option while in check, every evasion gets a look
+        board.generateMoves<GenType::EVASIONS>(tactical, info);
+        if (tactical.size == 0)
+            return -MATE_SCORE + ply;
+        if (ply >= MAX_PLY - 1)
+            return Evaluation::evaluate(board, info);
+        bestScore = -INFINITE_SCORE;
+    } else {
+        const int standPat = stack.staticEval = Evaluation::evaluate(board, info);
+        if (standPat >= beta || ply >= MAX_PLY - 1)
+            return standPat;
+        alpha = std::max(alpha, standPat);
+        bestScore = standPat;
+
+        // only captures and promotions are searched to quiet the position down,
+        // and captures that lose material in the exchange are not worth a look
+        board.generateMoves<GenType::CAPTURES>(tactical, info);
+        int kept = 0;
+        for (const Move move: tactical) {
+            if (move.promotion() != PieceType::EMPTY || Attacks::see(board.getPosition(), move, info) >= 0)
+                tactical[kept++] = move;
+        }
+        tactical.size = kept;
+    }
+
+    scoreMoves(board, info, ply, Move());
+
+    for (int i = 0; i < tactical.size; i++) {
+        pickMove(tactical, stack.scores, i);
+
+        Board child = board;
+        child.makeMove(tactical[i]);
+        const int score = -quiescence(child, ply + 1, -beta, -alpha);
+        if (aborted())
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                mPvTable.update(ply, tactical[i]);
+                if (score >= beta)
+                    break;
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+void Search::scoreMoves(const Board &board, const AttackInfo &info, const int ply, const Move hashMove) {
+    const MoveList &moves = mStack[ply].moves;
+    int *scores = mStack[ply].scores;
+    const Move *killers = mStack[ply].killers;
+    for (int i = 0; i < moves.size; i++) {
+        const Move move = moves[i];
+        const Piece victim = board.getPiece(rankOf(move.to()), fileOf(move.to()));
+        const Piece attacker = board.getPiece(rankOf(move.from()), fileOf(move.from()));
+
+        if (mFollowPv && move == (*mFollowLine)[ply]) {
+            scores[i] = PvMoveScore;
+        } else if (move == hashMove) {
+            scores[i] = HashMoveScore;
+        } else if (!victim.isEmpty()) {
+            // most valuable victim, least valuable attacker, captures losing the exchange go after the quiet moves
+            scores[i] = Evaluation::PieceValues[static_cast<int>(victim.type)] * 10 - static_cast<int>(attacker.type);
+            scores[i] += Attacks::see(board.getPosition(), move, info) >= 0 ? CaptureScore : -CaptureScore;
+        } else if (move == killers[0]) {
+            scores[i] = KillerScore;
+        } else if (move == killers[1]) {
+            scores[i] = KillerScore - 1;
+        } else {
+            scores[i] = move.promotion() == PieceType::QUEEN ? KillerScore + 1 : 0;
+        }
+    }
+}
+
+void Search::storeKiller(const int ply, const Move move) {
+    Move *killers = mStack[ply].killers;
+    if (killers[0] != move) {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+}
+
+bool Search::shouldStop() {
+    // helpers follow the main search, which alone watches the limits
+    if (mMain) {
+        if ((mNodes & 1023) == 0)
+            flushNodes();
+        if (mMain->mStopped.load(std::memory_order_relaxed))
+            mStopped = true;
+        return mStopped;
+    }
+
+    // the first iteration always completes so there is a move to play
+    if (mStopped || mRootDepth == 0)
+        return mStopped;
+
+    // checking the clock is expensive, only do it every few thousand nodes
+    // compare in milliseconds, converting an unlimited moveTime to nanoseconds would overflow
+    if ((mNodes & 2047) == 0) {
+        flushNodes();
+        // a refuted fallback comes before the limits, the quick first iteration without it replaces it
+        if (mUnsafeCount.load(std::memory_order_relaxed) > mUnsafeApplied && mRootMoves.size > 1 &&
+            isUnsafe(mRootPv.bestMove()))
+            mRestart = true;
+        else if (mSharedNodes.load(std::memory_order_relaxed) >= mLimits.maxNodes ||
+                 (mLimits.stop && mLimits.stop->load(std::memory_order_relaxed)) ||
+                 std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - mStartTime) >= mLimits.moveTime)
+            mStopped = true;
+    }
+
+    return aborted();
+}
@@ -0,0 +1,252 @@
+#ifndef CHESS_COMPETITION_SEARCH_H
+#define CHESS_COMPETITION_SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Attacks.h"
+#include "Board.h"
+#include "KeyHistory.h"
+#include "MateSolver.h"
+#include "Move.h"
+#include "TranspositionTable.h"
+
+constexpr int MAX_PLY = 64;
+constexpr int INFINITE_SCORE = 32000;
+constexpr int MATE_SCORE = 31000;
+// any score above this is a forced mate
+constexpr int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+// Triangular principal variation table. Row `ply` holds the best line found
+// from that ply onwards, and a new best move at `ply` is prepended to the row
+// below it. All storage is inline so no allocation happens while searching.
+class PvTable {
+public:
+    void clear(const int ply) { mLength[ply] = ply; }
+
+    void update(const int ply, const Move move) {
+        mMoves[ply][ply] = move;
+        for (int next = ply + 1; next < mLength[ply + 1]; next++)
+            mMoves[ply][next] = mMoves[ply + 1][next];
+        mLength[ply] = mLength[ply + 1];
+    }
+
+    // the principal variation as seen from the root
+    int length() const { return mLength[0]; }
+    Move operator[](const int index) const { return mMoves[0][index]; }
+    Move bestMove() const { return mLength[0] > 0 ? mMoves[0][0] : Move(); }
+
+    // replaces the principal variation from the root with a line found elsewhere
+    void assign(const std::vector<Move> &line) {
+        mLength[0] = std::min(static_cast<int>(line.size()), MAX_PLY);
+        std::copy_n(line.begin(), mLength[0], mMoves[0]);
+    }
+
+    std::string toString() const {
+        std::string line;
+        for (int i = 0; i < mLength[0]; i++) {
+            if (i > 0) line += ' ';
+            line += mMoves[0][i].toUci();
+        }
+        return line;
+    }
+
+private:
+    Move mMoves[MAX_PLY][MAX_PLY];
+    int mLength[MAX_PLY + 1] = {};
+};
+
+// What a node keeps while its children are searched. One entry per ply is
+// preallocated in the Search, so no node allocates once the search is running.
+struct SearchStackEntry {
+    MoveList moves;
+    int scores[256];
+    Move killers[2];
+    // the stand pat score, set by quiescence
+    int staticEval;
+};
+
+struct SearchLimits {
+    int maxDepth = MAX_PLY - 1;
+    std::chrono::milliseconds moveTime = std::chrono::milliseconds::max();
+    // summed over all threads, checked every few thousand nodes
+    uint64_t maxNodes = UINT64_MAX;
+    // threads searching the same position through the shared transposition table
+    int threads = 1;
+    // number of best root moves to find, each with its own principal variation
+    int multiPv = 1;
+    // when not empty only these root moves are searched, moves that are not legal are ignored
+    MoveList searchMoves;
+    // run the mate solver on a spare core of the shared pool, if there is one, for a single line
+    bool mateSolver = false;
+    // ends the search from another thread when set, after the first iteration; may be null
+    const std::atomic<bool> *stop = nullptr;
+};
+
+// One of the best root moves of a MultiPV search
+struct SearchLine {
+    PvTable pv;
+    int score = 0;
+};
+
+// Reported once per completed iteration
+struct SearchInfo {
+    int depth;
+    int score;
+    uint64_t nodes;
+    std::chrono::milliseconds elapsed;
+    const PvTable &pv;
+    // which of the MultiPV lines this is, 1 for the best
+    int multiPv;
+};
+
+// Lazy SMP: with several threads, helper searchers run the same iterative
+// deepening on their own stacks and only share the transposition table, which
+// they fill with results the main thread picks up. The move played is always
+// the main thread's.
+//
+// The mate solver, when asked for and when a core is left over, first looks
+// for a mate by the side to move. A proven mate ends the search and is played
+// unless the search found a shorter one. Otherwise it checks the move the
+// search currently prefers for a mate by the opponent, and every move it
+// refutes that way is taken out of the root from the next iteration on. When
+// the refuted move is the one the search would fall back on, the running
+// iteration is thrown away and iterative deepening starts over without it,
+// within the same time limit, so a refuted move is never played.
+class Search {
+public:
+    using InfoCallback = std::function<void(const SearchInfo &)>;
+
+    explicit Search(size_t hashMegabytes = TranspositionTable::DefaultMegabytes);
+    ~Search();
+
+    Search(const Search &) = delete;
+    Search &operator=(const Search &) = delete;
+
+    /**
+     * @brief Iterative deepening principal variation search inside aspiration windows
+     *
+     * @return Move The best move of the last completed iteration, null if there are no legal moves
+     */
+    Move findBestMove(const Board &board, const SearchLimits &limits);
+
+    // forgets the positions of earlier games, the table and helpers are kept
+    void newGame();
+
+    // takes a root move out of the running search, the way a mate the solver proves against it does;
+    // may be called from any thread, the info callback included
+    void refute(Move move);
+
+    void setInfoCallback(InfoCallback callback) { mInfoCallback = std::move(callback); }
+
+    const PvTable &getPv() const { return mRootPv; }
+    // the best root moves of the last completed iteration, best first
+    const std::vector<SearchLine> &getLines() const { return mLines; }
+    int getScore() const { return mRootScore; }
+    int getDepth() const { return mRootDepth; }
+    // summed over all threads
+    uint64_t getNodes() const { return mSharedNodes; }
+
+private:
+    // helpers share the table and stop flag of the main search
+    explicit Search(Search &main);
+
+    void iterate(const Board &board, int firstDepth);
+
+    // adds the nodes counted since the last call to the shared total
+    void flushNodes();
+
+    // the task of the spare core, runs until the search stops
+    void solveMates(const Board &board);
+
+    // drops the root moves the mate solver refuted since the last call, keeping at least one
+    void excludeUnsafeMoves();
+
+    // whether the mate solver found a forced mate against the move
+    bool isUnsafe(Move move) const;
+
+    // whether the running iteration is to be abandoned, for good or to start over
+    bool aborted() const { return mStopped.load(std::memory_order_relaxed) || mRestart; }
+
+    static constexpr int MateSolverMoves = 16;
+    // for each move the search prefers, so a hard one does not hold up the next
+    static constexpr uint64_t SafetyCheckNodes = 1 << 18;
+
+    // initial half width of the aspiration window in centipawns
+    static constexpr int AspirationDelta = 25;
+    static constexpr int AspirationMinDepth = 4;
+
+    int aspirationWindow(Board &board, int depth, int previousScore);
+
+    int pvSearch(Board &board, int depth, int ply, int alpha, int beta);
+
+    int quiescence(Board &board, int ply, int alpha, int beta);
+
+    // fills the scores of the moves in the stack entry of `ply`
+    void scoreMoves(const Board &board, const AttackInfo &info, int ply, Move hashMove);
+
+    void storeKiller(int ply, Move move);
+
+    bool shouldStop();
+
+    PvTable mPvTable;
+    // copy of the last completed iteration, searched first on the next one
+    PvTable mRootPv;
+    int mRootScore = 0;
+    int mRootDepth = 0;
+    bool mFollowPv = false;
+    // the line whose moves are boosted while mFollowPv holds
+    const PvTable *mFollowLine = nullptr;
+
+    // lines of the last completed iteration, and those of the running one
+    std::vector<SearchLine> mLines;
+    std::vector<SearchLine> mNextLines;
+    int mPvIndex = 0;
+    // the root moves allowed by searchmoves, and whether that excludes any
+    MoveList mRootMoves;
+    bool mRestricted = false;
+
+    SearchStackEntry mStack[MAX_PLY];
+
+    // results kept between iterations and between calls to findBestMove, owned by the main search
+    std::unique_ptr<TranspositionTable> mOwnedTable;
+    TranspositionTable *mTable;
+
+    Search *mMain = nullptr;
+    std::vector<std::unique_ptr<Search>> mHelpers;
+
+    // created on the first search that uses it, its table is kept between searches
+    std::unique_ptr<MateSolver> mMateSolver;
+    // read once the solver's task has finished
+    bool mMateFound = false;
+    // the best move of the last completed iteration, for the solver to check
+    std::atomic<uint16_t> mCandidate{0};
+    // moves that allow a forced mate, published by the count
+    Move mUnsafeMoves[256];
+    std::atomic<int> mUnsafeCount{0};
+    std::mutex mUnsafeMutex;
+    int mUnsafeApplied = 0;
+    // set by the main search once the move it would fall back on is refuted
+    bool mRestart = false;
+
+    // keys from the root to the current node, for repetition detection
+    KeyHistory mHistory;
+
+    uint64_t mNodes = 0;
+    uint64_t mFlushedNodes = 0;
+    std::atomic<uint64_t> mSharedNodes{0};
+    std::atomic<bool> mStopped{false};
+    SearchLimits mLimits;
+    std::chrono::steady_clock::time_point mStartTime;
+
+    InfoCallback mInfoCallback;
+};
+
+#endif //CHESS_COMPETITION_SEARCH_H
@@ -0,0 +1,179 @@
+#include "Sliders.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#elif defined(CHESS_COMPETITION_X86_64)
+#include <cpuid.h>
+#endif
+
+#include "Attacks.h"
+
+bool Sliders::UsePext = false;
+
+namespace {
+    // exactly as many entries as the relevant blocker subsets of all squares
+    Bitboard BishopTable[0x1480];
+    Bitboard RookTable[0x19000];
+
+    constexpr Attacks::Direction BishopDirections[4] = {
+        Attacks::NORTH_EAST, Attacks::NORTH_WEST, Attacks::SOUTH_EAST, Attacks::SOUTH_WEST
+    };
+    constexpr Attacks::Direction RookDirections[4] = {
+        Attacks::NORTH, Attacks::EAST, Attacks::SOUTH, Attacks::WEST
+    };
+
+    // found by `chesscli magics`, which searches for them again and checks they still match
+    constexpr Bitboard BishopMagics[64] = {
+        0x40106000A1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+        0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+        0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+        0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+        0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+        0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+        0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+        0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+        0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+        0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+        0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+        0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+        0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+        0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+        0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+        0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+    };
+    constexpr Bitboard RookMagics[64] = {
+        0x0A80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+        0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+        0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+        0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+        0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+        0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+        0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+        0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+        0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+        0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+        0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+        0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+        0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+        0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+        0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+        0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+    };
+
+    constexpr Bitboard slidingAttacks(const Attacks::Direction (&directions)[4], const int square,
+                                      const Bitboard occupancy) {
+        Bitboard attacks = 0;
+        for (const Attacks::Direction direction: directions)
+            attacks |= Attacks::rayAttacks(direction, square, occupancy);
+        return attacks;
+    }
+
+    // everything but the attacks themselves is known at compile time
+    constexpr std::array<Sliders::Entry, 64> makeEntries(const Attacks::Direction (&directions)[4],
+                                                         const Bitboard (&magics)[64], Bitboard *table) {
+        std::array<Sliders::Entry, 64> entries{};
+        for (int square = 0; square < 64; square++) {
+            Sliders::Entry &entry = entries[square];
+
+            // blockers on the board edge never shorten a ray, unless the piece stands on that edge
+            const Bitboard edges = ((Rank1Bitboard | Rank8Bitboard) & ~(Rank1Bitboard << 8 * rankOf(square)))
+                                   | ((FileABitboard | FileHBitboard) & ~(FileABitboard << fileOf(square)));
+            entry.mask = slidingAttacks(directions, square, 0) & ~edges;
+            entry.magic = magics[square];
+            entry.shift = 64 - popCount(entry.mask);
+            entry.attacks = square == 0 ? table : entries[square - 1].attacks + (1 << (64 - entries[square - 1].shift));
+        }
+        return entries;
+    }
+
+    // magics and pext index the same slice of the table, only the order within it differs
+    void fillTable(const std::array<Sliders::Entry, 64> &entries, const Attacks::Direction (&directions)[4],
+                   const Sliders::Backend backend) {
+        for (int square = 0; square < 64; square++) {
+            const Sliders::Entry &entry = entries[square];
+
+            // walk every subset of the mask
+            Bitboard subset = 0;
+            do {
+                const Bitboard index = backend == Sliders::Backend::PEXT
+                                           ? Sliders::pext(subset, entry.mask)
+                                           : (subset * entry.magic) >> entry.shift;
+                entry.attacks[index] = slidingAttacks(directions, square, subset);
+                subset = (subset - entry.mask) & entry.mask;
+            } while (subset);
+        }
+    }
+
+    void cpuid(const unsigned leaf, unsigned (&registers)[4]) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), 0);
+        std::copy(values, values + 4, registers);
+#elif defined(CHESS_COMPETITION_X86_64)
+        __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+#else
+        (void) leaf;
+        std::fill(registers, registers + 4, 0u);
+#endif
+    }
+
+    bool hasBmi2() {
+        unsigned registers[4];
+        cpuid(0, registers);
+        if (registers[0] < 7)
+            return false;
+        cpuid(7, registers);
+        return registers[1] & (1u << 8);
+    }
+
+    Sliders::Backend defaultBackend() {
+        return Sliders::hasFastPext() ? Sliders::Backend::PEXT : Sliders::Backend::MAGIC;
+    }
+
+    // fills the tables before main runs, the engine never sees them empty
+    [[maybe_unused]] const bool Initialised = Sliders::select(defaultBackend());
+}
+
+constexpr std::array<Sliders::Entry, 64> Sliders::Bishop = makeEntries(BishopDirections, BishopMagics, BishopTable);
+constexpr std::array<Sliders::Entry, 64> Sliders::Rook = makeEntries(RookDirections, RookMagics, RookTable);
+
+bool Sliders::hasFastPext() {
+#ifdef CHESS_COMPETITION_X86_64
+    if (!hasBmi2())
+        return false;
+
+    // the vendor string is spread over ebx, edx, ecx
+    unsigned registers[4];
+    cpuid(0, registers);
+    const bool amd = registers[1] == 0x68747541 && registers[3] == 0x69746e65 && registers[2] == 0x444d4163;
+    const bool hygon = registers[1] == 0x6f677948 && registers[3] == 0x6e65476e && registers[2] == 0x656e6975;
+
+    // AMD before Zen 3 runs pext in microcode, far slower than a multiplication
+    cpuid(1, registers);
+    const unsigned baseFamily = (registers[0] >> 8) & 0xF;
+    const unsigned family = baseFamily == 0xF ? baseFamily + ((registers[0] >> 20) & 0xFF) : baseFamily;
+    return !((amd || hygon) && family < 0x19);
+#else
+    return false;
+#endif
+}
+
+Sliders::Backend Sliders::backend() {
+    return UsePext ? Backend::PEXT : Backend::MAGIC;
+}
+
+const char *Sliders::backendName(const Backend backend) {
+    return backend == Backend::PEXT ? "pext" : "magic";
+}
+
+bool Sliders::select(const Backend backend) {
+    if (backend == Backend::PEXT && !hasBmi2())
+        return false;
+
+    fillTable(Bishop, BishopDirections, backend);
+    fillTable(Rook, RookDirections, backend);
+    UsePext = backend == Backend::PEXT;
+    return true;
+}
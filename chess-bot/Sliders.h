@@ -0,0 +1,73 @@
+#ifndef CHESS_COMPETITION_SLIDERS_H
+#define CHESS_COMPETITION_SLIDERS_H
+
+#include <array>
+#include <cstdint>
+
+#include "Bitboard.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define CHESS_COMPETITION_X86_64
+#elif defined(__x86_64__)
+#define CHESS_COMPETITION_X86_64
+#endif
+
+// Bishop and rook attacks looked up in precomputed tables. Every square owns a
+// slice of the table indexed by the blockers on its relevant squares, turned into
+// an index either by a magic multiplication or by the BMI2 pext instruction.
+// The backend is picked once when the program starts: pext where the CPU has it
+// and runs it in hardware, magics everywhere else.
+namespace Sliders {
+    enum class Backend { MAGIC, PEXT };
+
+    struct Entry {
+        // the squares whose occupancy changes the attacks, edges excluded
+        Bitboard mask;
+        Bitboard magic;
+        Bitboard *attacks;
+        int shift;
+    };
+
+    // generated at compile time, with magics found once and kept in the source
+    extern const std::array<Entry, 64> Bishop;
+    extern const std::array<Entry, 64> Rook;
+    extern bool UsePext;
+
+    inline Bitboard pext(const Bitboard value, const Bitboard mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return _pext_u64(value, mask);
+#elif defined(CHESS_COMPETITION_X86_64)
+        // plain asm so the instruction is available without building the whole engine for BMI2
+        Bitboard result;
+        asm("pextq %2, %1, %0" : "=r"(result) : "r"(value), "r"(mask));
+        return result;
+#else
+        // never selected, there is no pext here
+        (void) value;
+        (void) mask;
+        return 0;
+#endif
+    }
+
+    inline Bitboard attacks(const Entry &entry, const Bitboard occupancy) {
+        if (UsePext)
+            return entry.attacks[pext(occupancy, entry.mask)];
+        return entry.attacks[((occupancy & entry.mask) * entry.magic) >> entry.shift];
+    }
+
+    // true when the CPU has BMI2 and does not emulate pext in microcode
+    bool hasFastPext();
+
+    Backend backend();
+    const char *backendName(Backend backend);
+
+    /**
+     * @brief Fill the tables for a backend, for validating and benchmarking both
+     *
+     * @return bool False, leaving the tables untouched, when the CPU cannot run the backend
+     */
+    bool select(Backend backend);
+} // namespace Sliders
+
+#endif //CHESS_COMPETITION_SLIDERS_H
@@ -0,0 +1,201 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+    // the pool and queue of the calling thread, when it is a worker
+    thread_local const ThreadPool *CurrentPool = nullptr;
+    thread_local int CurrentWorker = -1;
+
+    // the cores this process may run on, which in a container or under taskset
+    // can be far fewer than the machine has
+    std::vector<int> allowedCores() {
+        std::vector<int> cores;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int core = 0; core < CPU_SETSIZE; core++) {
+                if (CPU_ISSET(core, &set))
+                    cores.push_back(core);
+            }
+        }
+#elif defined(_WIN32)
+        DWORD_PTR processMask, systemMask;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+            for (int core = 0; core < static_cast<int>(sizeof(DWORD_PTR) * 8); core++) {
+                if (processMask >> core & 1)
+                    cores.push_back(core);
+            }
+        }
+#endif
+        return cores;
+    }
+}
+
+ThreadPool::ThreadPool(int threads, const bool pinned) {
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 0; i < threads; i++)
+        mQueues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threads; i++)
+        mWorkers.emplace_back([this, i] { workerLoop(i); });
+    if (pinned)
+        pin();
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(static_cast<int>(allowedCores().size()), true);
+    return pool;
+}
+
+void ThreadPool::pin() {
+    const std::vector<int> cores = allowedCores();
+    if (cores.empty())
+        return;
+
+    // a worker per core, wrapping around when there are more workers than cores
+    mPinned = true;
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        const int core = cores[i % cores.size()];
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        mPinned = pthread_setaffinity_np(mWorkers[i].native_handle(), sizeof(set), &set) == 0 && mPinned;
+#elif defined(_WIN32)
+        const auto handle = static_cast<HANDLE>(mWorkers[i].native_handle());
+        mPinned = SetThreadAffinityMask(handle, static_cast<DWORD_PTR>(1) << core) != 0 && mPinned;
+#else
+        (void) core;
+        mPinned = false;
+#endif
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (auto &worker: mWorkers)
+        worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+    const int index = CurrentPool == this
+                          ? CurrentWorker
+                          : static_cast<int>(mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size());
+
+    mPending.fetch_add(1);
+    {
+        std::lock_guard lock(mQueues[index]->mutex);
+        mQueues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // under the lock, so a worker about to sleep cannot miss it
+        std::lock_guard lock(mMutex);
+        mQueued.fetch_add(1);
+    }
+    mWake.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(mMutex);
+    mDone.wait(lock, [this] { return mPending.load() == 0; });
+}
+
+bool ThreadPool::takeTask(const int index, Task &task) {
+    // newest of our own first, it is the most likely to still be in cache
+    {
+        Queue &own = *mQueues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            mQueued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // then the oldest of someone else's, the biggest piece of work they have
+    for (size_t offset = 1; offset < mQueues.size(); offset++) {
+        Queue &victim = *mQueues[(index + offset) % mQueues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            mQueued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(Task &task) {
+    task();
+    if (mPending.fetch_sub(1) == 1) {
+        std::lock_guard lock(mMutex);
+        mDone.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(const int index) {
+    CurrentPool = this;
+    CurrentWorker = index;
+
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock lock(mMutex);
+        mWake.wait(lock, [this] { return mStopping || mQueued.load() > 0; });
+        if (mStopping && mQueued.load() == 0)
+            return;
+    }
+}
+
+void ThreadPool::Batch::submit(Task task) {
+    mPending.fetch_add(1);
+    mPool.submit([this, task = std::move(task)] {
+        task();
+        // under the lock, so the batch cannot be gone before the notification is out
+        std::lock_guard lock(mMutex);
+        if (mPending.fetch_sub(1) == 1)
+            mDone.notify_all();
+    });
+}
+
+void ThreadPool::Batch::wait() {
+    // a worker waiting on its own pool could leave the batch with no one to run it
+    if (CurrentPool == &mPool) {
+        while (mPending.load() > 0) {
+            Task task;
+            if (mPool.takeTask(CurrentWorker, task)) {
+                mPool.runTask(task);
+                continue;
+            }
+            std::unique_lock lock(mMutex);
+            mDone.wait_for(lock, std::chrono::milliseconds(1), [this] { return mPending.load() == 0; });
+        }
+    }
+
+    // also waits for the last task to let go of the lock
+    std::unique_lock lock(mMutex);
+    mDone.wait(lock, [this] { return mPending.load() == 0; });
+}
@@ -0,0 +1,97 @@
+#ifndef CHESS_COMPETITION_THREAD_POOL_H
+#define CHESS_COMPETITION_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers with one task queue each. A worker takes the newest task
+// from its own queue and, once that runs dry, steals the oldest task from
+// another one, so tasks that split themselves keep their subtasks local while
+// idle workers pick up the large, old pieces of work. Idle workers sleep on a
+// condition variable, so a parked pool costs nothing.
+//
+// shared() is the process-wide pool the search, MCTS and perft run on. It is
+// created once, on first use, with a worker per core the process may run on,
+// each pinned to its core where the system allows it, so starting a search is
+// a wake-up rather than a thread creation.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // Tasks whose completion is waited on apart from everything else on the pool,
+    // so several users can share one pool without waiting for each other.
+    class Batch {
+    public:
+        explicit Batch(ThreadPool &pool) : mPool(pool) {}
+        ~Batch() { wait(); }
+
+        Batch(const Batch &) = delete;
+        Batch &operator=(const Batch &) = delete;
+
+        void submit(Task task);
+
+        // block until every task of the batch has finished; a worker runs queued tasks meanwhile
+        void wait();
+
+    private:
+        ThreadPool &mPool;
+        std::mutex mMutex;
+        std::condition_variable mDone;
+        std::atomic<int> mPending{0};
+    };
+
+    // zero threads means one per hardware thread
+    explicit ThreadPool(int threads = 0, bool pinned = false);
+    ~ThreadPool();
+
+    static ThreadPool &shared();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // from a worker the task goes to its own queue, otherwise queues take turns
+    void submit(Task task);
+
+    // block until every submitted task, including those submitted by tasks, has finished
+    void wait();
+
+    int size() const { return static_cast<int>(mWorkers.size()); }
+
+    // whether the workers could be pinned to their cores
+    bool isPinned() const { return mPinned; }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int index);
+
+    bool takeTask(int index, Task &task);
+
+    void runTask(Task &task);
+
+    void pin();
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    // tasks sitting in a queue, and tasks not yet finished
+    std::atomic<int> mQueued{0};
+    std::atomic<int> mPending{0};
+    std::atomic<unsigned> mNextQueue{0};
+    bool mStopping = false;
+    bool mPinned = false;
+};
+
+#endif //CHESS_COMPETITION_THREAD_POOL_H
@@ -0,0 +1,132 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "ThreadPool.h"
+
+namespace {
+    constexpr size_t HugePageSize = 2 * 1024 * 1024;
+
+    void *allocateAligned(const size_t bytes) {
+#ifdef _WIN32
+        return _aligned_malloc(bytes, HugePageSize);
+#else
+        return std::aligned_alloc(HugePageSize, bytes);
+#endif
+    }
+
+    void freeAligned(void *memory) {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+TranspositionTable::TranspositionTable(const size_t megabytes) {
+    resize(megabytes);
+}
+
+TranspositionTable::~TranspositionTable() {
+    freeAligned(mBuckets);
+}
+
+void TranspositionTable::resize(const size_t megabytes) {
+    freeAligned(mBuckets);
+    mBuckets = nullptr;
+    mHugePages = false;
+
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= std::max<size_t>(megabytes, 1) << 20)
+        count *= 2;
+
+    // halve until the allocation succeeds, a smaller table beats no table
+    while (true) {
+        // aligned_alloc wants the size to be a multiple of the alignment
+        const size_t bytes = (count * sizeof(Bucket) + HugePageSize - 1) / HugePageSize * HugePageSize;
+        mBuckets = static_cast<Bucket *>(allocateAligned(bytes));
+        if (mBuckets) {
+#ifdef MADV_HUGEPAGE
+            mHugePages = madvise(mBuckets, bytes, MADV_HUGEPAGE) == 0;
+#endif
+            break;
+        }
+        if (count == 1)
+            break;
+        count /= 2;
+    }
+    mBucketCount = mBuckets ? count : 0;
+
+    clear();
+}
+
+void TranspositionTable::clear() {
+    mGeneration = 0;
+    if (!mBuckets)
+        return;
+
+    // also the first touch of every page, which is most of the cost on a fresh table;
+    // spread over the persistent pool, so clearing never creates threads
+    ThreadPool &pool = ThreadPool::shared();
+    const size_t chunk = (mBucketCount + pool.size() - 1) / pool.size();
+    ThreadPool::Batch workers(pool);
+    for (size_t start = 0; start < mBucketCount; start += chunk) {
+        const size_t count = std::min(chunk, mBucketCount - start);
+        workers.submit([this, start, count] {
+            std::memset(static_cast<void *>(mBuckets + start), 0, count * sizeof(Bucket));
+        });
+    }
+    workers.wait();
+}
+
+bool TranspositionTable::probe(const uint64_t key, TTEntry &entry) const {
+    const uint16_t check = static_cast<uint16_t>(key >> 48);
+    // entries are read and written whole, other search threads may be storing into the bucket
+    for (const TTEntry candidate: bucket(key)->entries) {
+        if (candidate.key == check && candidate.bound() != Bound::NONE) {
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(const uint64_t key, const Move move, const int score, const int depth,
+                               const Bound bound) {
+    const uint16_t check = static_cast<uint16_t>(key >> 48);
+    Bucket *target = bucket(key);
+
+    // overwrite the same position, otherwise the shallowest entry, older searches counting as shallower
+    TTEntry *replace = &target->entries[0];
+    int worst = 1 << 30;
+    for (TTEntry &candidate: target->entries) {
+        if (candidate.key == check || candidate.bound() == Bound::NONE) {
+            replace = &candidate;
+            break;
+        }
+
+        const int age = ((mGeneration - candidate.generationBound) & 0xFC) >> 2;
+        const int value = candidate.depth - 2 * age;
+        if (value < worst) {
+            worst = value;
+            replace = &candidate;
+        }
+    }
+
+    // a re-store without a move keeps the move found earlier
+    TTEntry updated = *replace;
+    if (!move.isNull() || updated.key != check)
+        updated.move = move;
+    updated.key = check;
+    updated.score = static_cast<int16_t>(score);
+    updated.depth = static_cast<uint8_t>(std::max(depth, 0));
+    updated.generationBound = static_cast<uint8_t>(mGeneration | static_cast<uint8_t>(bound));
+    *replace = updated;
+}
@@ -0,0 +1,89 @@
+#ifndef CHESS_COMPETITION_TRANSPOSITION_TABLE_H
+#define CHESS_COMPETITION_TRANSPOSITION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#include "Move.h"
+
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+// 8 bytes, so a bucket of eight fills exactly one cache line
+struct TTEntry {
+    // the top bits of the key, the low bits already picked the bucket
+    uint16_t key;
+    Move move;
+    int16_t score;
+    uint8_t depth;
+    // search generation in the upper six bits, Bound in the lower two
+    uint8_t generationBound;
+
+    Bound bound() const { return static_cast<Bound>(generationBound & 3); }
+};
+
+static_assert(sizeof(TTEntry) == 8, "eight entries must share a cache line");
+
+// Hash table of search results shared between iterations. It is allocated on a
+// 2 MB boundary and, on Linux, marked for transparent huge pages, since at
+// high node rates the probes are bound by TLB and cache misses.
+class TranspositionTable {
+public:
+    static constexpr size_t DefaultMegabytes = 16;
+
+    explicit TranspositionTable(size_t megabytes = DefaultMegabytes);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    // drops every entry, the table is rounded down to a power of two buckets
+    void resize(size_t megabytes);
+
+    // zero the table, split over all hardware threads so large tables stay quick to set up
+    void clear();
+
+    // ages every stored entry, call once per search
+    void newSearch() { mGeneration += 4; }
+
+    /**
+     * @brief Look up a position
+     *
+     * @return bool True when an entry for the key was found and copied into `entry`
+     */
+    bool probe(uint64_t key, TTEntry &entry) const;
+
+    // score is relative to the node, mate scores must already be adjusted for the ply
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+
+    // start loading the bucket of a key the search is about to probe
+    void prefetch(const uint64_t key) const {
+#if defined(_MSC_VER)
+        _mm_prefetch(reinterpret_cast<const char *>(bucket(key)), _MM_HINT_T0);
+#else
+        __builtin_prefetch(bucket(key));
+#endif
+    }
+
+    size_t megabytes() const { return mBucketCount * sizeof(Bucket) >> 20; }
+
+    // whether the kernel was asked to back the table with huge pages
+    bool hugePages() const { return mHugePages; }
+
+private:
+    struct alignas(64) Bucket {
+        TTEntry entries[8];
+    };
+
+    Bucket *bucket(const uint64_t key) const { return &mBuckets[key & (mBucketCount - 1)]; }
+
+    Bucket *mBuckets = nullptr;
+    size_t mBucketCount = 0;
+    uint8_t mGeneration = 0;
+    bool mHugePages = false;
+};
+
+#endif //CHESS_COMPETITION_TRANSPOSITION_TABLE_H
@@ -0,0 +1,82 @@
+#ifndef CHESS_COMPETITION_ZOBRIST_H
+#define CHESS_COMPETITION_ZOBRIST_H
+
+#include <cstdint>
+
+#include "Piece.h"
+
+namespace Zobrist {
+    struct Keys {
+        // indexed by [PieceColor][PieceType][square]
+        uint64_t pieces[2][7][64];
+        // one key per castling rights mask
+        uint64_t castling[16];
+        // indexed by the file of the en passant square
+        uint64_t enPassant[8];
+        uint64_t blackToMove;
+    };
+
+    namespace detail {
+        // std::mt19937_64, which cannot run at compile time. Same seed, same keys.
+        class MersenneTwister {
+        public:
+            constexpr explicit MersenneTwister(const uint64_t seed) {
+                mState[0] = seed;
+                for (int i = 1; i < Size; i++)
+                    mState[i] = 6364136223846793005ULL * (mState[i - 1] ^ (mState[i - 1] >> 62)) + i;
+            }
+
+            constexpr uint64_t operator()() {
+                if (mIndex == Size)
+                    twist();
+
+                uint64_t value = mState[mIndex++];
+                value ^= (value >> 29) & 0x5555555555555555ULL;
+                value ^= (value << 17) & 0x71D67FFFEDA60000ULL;
+                value ^= (value << 37) & 0xFFF7EEE000000000ULL;
+                return value ^ (value >> 43);
+            }
+
+        private:
+            static constexpr int Size = 312;
+
+            constexpr void twist() {
+                for (int i = 0; i < Size; i++) {
+                    const uint64_t bits = (mState[i] & 0xFFFFFFFF80000000ULL) | (mState[(i + 1) % Size] & 0x7FFFFFFFULL);
+                    mState[i] = mState[(i + 156) % Size] ^ (bits >> 1) ^ (bits & 1 ? 0xB5026F5AA96619E9ULL : 0);
+                }
+                mIndex = 0;
+            }
+
+            uint64_t mState[Size]{};
+            int mIndex = Size;
+        };
+
+        constexpr Keys generateKeys() {
+            // fixed seed so hashes are reproducible between runs
+            MersenneTwister generator(0x5A0B1A57C0FFEEULL);
+            Keys keys{};
+
+            for (auto &color: keys.pieces)
+                for (auto &type: color)
+                    for (auto &key: type)
+                        key = generator();
+            for (auto &key: keys.castling)
+                key = generator();
+            for (auto &key: keys.enPassant)
+                key = generator();
+            keys.blackToMove = generator();
+
+            return keys;
+        }
+    }
+
+    // generated by the compiler, so there is nothing to set up when the program starts
+    inline constexpr Keys keys = detail::generateKeys();
+
+    inline uint64_t pieceKey(const Piece piece, const int square) {
+        return keys.pieces[static_cast<int>(piece.color)][static_cast<int>(piece.type)][square];
+    }
+} // namespace Zobrist
+
+#endif //CHESS_COMPETITION_ZOBRIST_H
@@ -2,29 +2,132 @@
 // disservin's lib. drop a star on his hard work!
 // https://github.com/Disservin/chess-library
 #include "chess.hpp"
-#include <random>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
 
 #include "Board.h"
+#include "Mcts.h"
+#include "Search.h"
+#include "ThreadPool.h"
 using namespace ChessSimulator;
 
+namespace {
+// each turn must take less than 10 seconds, leave plenty of margin
+constexpr auto MoveTimeBudget = std::chrono::milliseconds(3000);
+
+enum class Engine { ALPHA_BETA, MCTS };
+
+// picked with the CHESS_ENGINE environment variable, alpha-beta unless it says mcts
+Engine selectedEngine() {
+  static const Engine engine = [] {
+    const char *name = std::getenv("CHESS_ENGINE");
+    return name && !std::strcmp(name, "mcts") ? Engine::MCTS : Engine::ALPHA_BETA;
+  }();
+  return engine;
+}
+
+// one search per calling thread for the whole game, shared by Move and Analyse: its
+// table carries over from call to call and none pays for allocating and clearing a new one
+Search &threadSearch() {
+  thread_local Search search;
+  return search;
+}
+
+::Move mctsMove(const Board &board, std::chrono::milliseconds moveTime, const MoveOptions &options,
+               MoveStats &stats) {
+  // one tree per calling thread for the whole game, so the subtree of the moves
+  // played is reused next turn and concurrent callers never wait for each other
+  thread_local std::unique_ptr<Mcts> mcts;
+
+  // pools sized for the move, a larger budget gets new ones; the time that takes
+  // comes out of the move, so the whole call stays within it
+  const auto start = std::chrono::steady_clock::now();
+  const int threads = options.threads > 0 ? options.threads : ThreadPool::shared().size();
+  const uint32_t capacity = Mcts::capacityFor(moveTime, threads);
+  if (!mcts || mcts->getCapacity() < capacity) {
+    mcts.reset();
+    mcts = std::make_unique<Mcts>(capacity);
+    const auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    moveTime = std::max(moveTime - spent, std::chrono::milliseconds(1));
+  }
+
+  MctsLimits limits;
+  limits.moveTime = moveTime;
+  limits.threads = threads;
+  limits.playoutPlies = options.playoutPlies;
+  limits.stop = options.stop;
+  const ::Move move = mcts->findBestMove(board, limits);
+  stats.nodes = mcts->getPlayouts();
+  stats.score = mcts->getScore();
+  return move;
+}
+}
+
 std::string ChessSimulator::Move(std::string fen) {
+  return Move(std::move(fen), static_cast<int>(MoveTimeBudget.count()));
+}
+
+std::string ChessSimulator::Move(std::string fen, int moveTimeMs) {
+  return MoveWithStats(std::move(fen), moveTimeMs).move;
+}
+
+MoveStats ChessSimulator::MoveWithStats(std::string fen, int moveTimeMs, const MoveOptions &options) {
   // create your board based on the board string following the FEN notation
   // search for the best move using minimax / monte carlo tree search /
   // alpha-beta pruning / ... try to use nice heuristics to speed up the search
   // and have better results return the best move in UCI notation you will gain
   // extra points if you create your own board/move representation instead of
   // using the one provided by the library
+  Board board(fen);
+
+  MoveStats stats;
+  ::Move move;
+  if (selectedEngine() == Engine::MCTS) {
+    move = mctsMove(board, std::chrono::milliseconds(moveTimeMs), options, stats);
+  } else {
+    SearchLimits limits;
+    limits.moveTime = std::chrono::milliseconds(moveTimeMs);
+    // Lazy SMP on the persistent pool, whose workers are already running
+    const int cores = ThreadPool::shared().size();
+    limits.threads = options.threads > 0 ? options.threads : cores - (options.mateSolver && cores > 2 ? 1 : 0);
+    limits.mateSolver = options.mateSolver;
+    limits.stop = options.stop;
+
+    Search &search = threadSearch();
+    move = search.findBestMove(board, limits);
+    stats.depth = search.getDepth();
+    stats.nodes = search.getNodes();
+    stats.score = search.getScore();
+  }
+  if (!move.isNull())
+    stats.move = move.toUci();
+  return stats;
+}
 
-  // here goes a random movement
+std::vector<AnalysisLine> ChessSimulator::Analyse(std::string fen, int lines,
+                                                  const std::vector<std::string> &searchMoves,
+                                                  int moveTimeMs) {
   Board board(fen);
-  auto moves = board.getValidMoves(board.getCurrentColor());
-  if(moves.size() == 0)
-    return "";
-
-  // get random move
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<> dist(0, moves.size() - 1);
-  auto move = moves[dist(gen)];
-  return move;
-}
\ No newline at end of file
+
+  SearchLimits limits;
+  limits.moveTime = std::chrono::milliseconds(moveTimeMs);
+  limits.multiPv = lines;
+  for (const auto &uci : searchMoves) {
+    if (limits.searchMoves.size < static_cast<int>(limits.searchMoves.moves.size()))
+      limits.searchMoves.push(::Move::fromUci(uci));
+  }
+
+  Search &search = threadSearch();
+  if (search.findBestMove(board, limits).isNull())
+    return {};
+
+  std::vector<AnalysisLine> analysis;
+  for (const auto &line : search.getLines())
+    analysis.push_back({line.pv.bestMove().toUci(), line.score, line.pv.toString()});
+  return analysis;
+}
@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace ChessSimulator {
 /**
@@ -9,4 +12,71 @@ namespace ChessSimulator {
  * @return std::string The move as UCI
  */
 std::string Move(std::string fen);
+
+/**
+ * @brief Move a piece on the board within a given time, for fast games
+ *
+ * @param fen The board as FEN
+ * @param moveTimeMs Search time in milliseconds
+ * @return std::string The move as UCI
+ */
+std::string Move(std::string fen, int moveTimeMs);
+
+// What the search behind a move got to, for tools that time the engine
+struct MoveStats {
+  // empty if there is no legal move
+  std::string move;
+  // last completed iteration, zero for MCTS
+  int depth = 0;
+  // nodes searched, or playouts for MCTS
+  uint64_t nodes = 0;
+  // centipawns from the point of view of the side to move
+  int score = 0;
+};
+
+// How MoveWithStats searches, the defaults are what Move does
+struct MoveOptions {
+  // search threads, zero for every core of the shared pool; alpha-beta leaves
+  // one of them to the mate solver when there are more than two
+  int threads = 0;
+  // run the mate solver on a core the search leaves idle; callers that search
+  // several positions at once should turn it off, their cores are all busy
+  bool mateSolver = true;
+  // MCTS only: random plies played out before the static evaluation, zero evaluates the leaf itself
+  int playoutPlies = 0;
+  // cuts the search short from another thread when set, may be null
+  const std::atomic<bool> *stop = nullptr;
+};
+
+/**
+ * @brief Move, also reporting what the search found
+ *
+ * @param fen The board as FEN
+ * @param moveTimeMs Search time in milliseconds
+ * @param options Threads and stop flag of the search
+ * @return MoveStats The move as UCI with the depth, nodes and score of the search
+ */
+MoveStats MoveWithStats(std::string fen, int moveTimeMs, const MoveOptions &options = {});
+
+// One ranked move of an analysis
+struct AnalysisLine {
+  std::string move;
+  // centipawns from the point of view of the side to move
+  int score;
+  // principal variation as UCI moves separated by spaces, starting with move
+  std::string pv;
+};
+
+/**
+ * @brief Rank the best moves of a position in a single MultiPV search
+ *
+ * @param fen The board as FEN
+ * @param lines How many moves to rank
+ * @param searchMoves UCI moves to choose from, every legal move when empty
+ * @param moveTimeMs Search time in milliseconds
+ * @return std::vector<AnalysisLine> Best move first, empty if there are no legal moves
+ */
+std::vector<AnalysisLine> Analyse(std::string fen, int lines,
+                                  const std::vector<std::string> &searchMoves = {},
+                                  int moveTimeMs = 3000);
 } // namespace ChessSimulator
\ No newline at end of file
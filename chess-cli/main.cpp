@@ -1,11 +1,758 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "chess-simulator.h"
 #include <string>
 
+// disservin's lib, the reference move generator the engine is checked against
+#include "chess.hpp"
+
+#include "Attacks.h"
 #include "Board.h"
+#include "MateSolver.h"
+#include "Perft.h"
+#include "Search.h"
+#include "Sliders.h"
+#include "ThreadPool.h"
+
+namespace {
+    // positions with castling, en passant, promotions and pins, see the chessprogramming wiki perft results
+    const char *PerftPositions[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    };
+
+    uint64_t referencePerft(chess::Board &board, const int depth) {
+        chess::Movelist moves;
+        chess::movegen::legalmoves(moves, board);
+        if (depth == 1)
+            return moves.size();
+
+        uint64_t nodes = 0;
+        for (const auto &move: moves) {
+            board.makeMove(move);
+            nodes += referencePerft(board, depth - 1);
+            board.unmakeMove(move);
+        }
+        return nodes;
+    }
+
+    /**
+     * @brief Parallel, optionally hashed perft over a fen or the standard positions
+     *
+     * With --verify every root move's count is compared against chess::Board,
+     * and the moves that disagree are printed.
+     *
+     * @return int 0 when every count matched the reference, 1 otherwise
+     */
+    int runPerft(const int argc, char *argv[]) {
+        int depth = 5;
+        int threads = 0;
+        size_t hashMegabytes = 0;
+        bool verify = false;
+        std::vector<std::string> fens;
+
+        for (int i = 2; i < argc; i++) {
+            if (!std::strcmp(argv[i], "--fen") && i + 1 < argc) {
+                fens.emplace_back(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+                threads = std::stoi(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+                hashMegabytes = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--verify")) {
+                verify = true;
+            } else if (argv[i][0] != '-') {
+                depth = std::stoi(argv[i]);
+            } else {
+                std::cout << "usage: chesscli perft [depth] [--fen FEN] [--threads N] [--hash MB] [--verify]"
+                          << std::endl;
+                return 1;
+            }
+        }
+        if (fens.empty())
+            fens.assign(std::begin(PerftPositions), std::end(PerftPositions));
+
+        bool matched = true;
+        for (const auto &fen: fens) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto entries = Perft::divide(Board(fen), depth, threads, hashMegabytes);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            uint64_t nodes = 0;
+            for (const auto &entry: entries)
+                nodes += entry.nodes;
+            std::cout << "perft " << depth << " " << fen << "\n  " << nodes << " nodes " << elapsed.count() << "ms";
+            if (elapsed.count() > 0)
+                std::cout << " " << nodes / elapsed.count() * 1000 << " nps";
+            std::cout << std::endl;
+
+            if (!verify)
+                continue;
+
+            chess::Board reference(fen);
+            uint64_t referenceNodes = 0;
+            for (const auto &entry: entries) {
+                const auto move = chess::uci::uciToMove(reference, entry.move.toUci());
+                reference.makeMove(move);
+                const uint64_t expected = depth == 1 ? 1 : referencePerft(reference, depth - 1);
+                reference.unmakeMove(move);
+
+                referenceNodes += expected;
+                if (expected != entry.nodes)
+                    std::cout << "  " << entry.move.toUci() << " " << entry.nodes << " expected " << expected << "\n";
+            }
+
+            // moves the engine missed entirely only show up in the move count
+            chess::Movelist referenceMoves;
+            chess::movegen::legalmoves(referenceMoves, reference);
+            const bool same = referenceNodes == nodes && referenceMoves.size() == static_cast<int>(entries.size());
+            std::cout << "  chess::Board " << (same ? "agrees" : "DISAGREES") << " (" << referenceMoves.size()
+                      << " root moves)" << std::endl;
+            matched = matched && same;
+        }
+
+        return matched ? 0 : 1;
+    }
+
+    // short algebraic notation without check marks, for matching the moves of EPD suites
+    std::string toSan(const Board &board, const Move move) {
+        constexpr const char *PieceLetters = " PNBRQK";
+        const Piece piece = board.getPiece(rankOf(move.from()), fileOf(move.from()));
+        const bool capture = !board.getPiece(rankOf(move.to()), fileOf(move.to())).isEmpty() ||
+                             (piece.type == PieceType::PAWN && fileOf(move.from()) != fileOf(move.to()));
+        const std::string to = move.toUci().substr(2, 2);
+
+        if (piece.type == PieceType::KING && std::abs(fileOf(move.from()) - fileOf(move.to())) == 2)
+            return fileOf(move.to()) == 6 ? "O-O" : "O-O-O";
+
+        std::string san;
+        if (piece.type == PieceType::PAWN) {
+            if (capture)
+                san += static_cast<char>('a' + fileOf(move.from()));
+        } else {
+            san += PieceLetters[static_cast<int>(piece.type)];
+
+            // name the file, else the rank, else both, of the piece when another one could go there too
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            MoveList moves;
+            board.getLegalMoves(moves);
+            for (const Move other: moves) {
+                if (other.to() != move.to() || other.from() == move.from() ||
+                    board.getPiece(rankOf(other.from()), fileOf(other.from())).type != piece.type)
+                    continue;
+                ambiguous = true;
+                sameFile = sameFile || fileOf(other.from()) == fileOf(move.from());
+                sameRank = sameRank || rankOf(other.from()) == rankOf(move.from());
+            }
+            if (ambiguous && (!sameFile || sameRank))
+                san += static_cast<char>('a' + fileOf(move.from()));
+            if (ambiguous && sameFile)
+                san += static_cast<char>('1' + rankOf(move.from()));
+        }
+
+        if (capture)
+            san += 'x';
+        san += to;
+        if (move.promotion() != PieceType::EMPTY)
+            san += std::string("=") + PieceLetters[static_cast<int>(move.promotion())];
+        return san;
+    }
+
+    // the legal move written as SAN or UCI, null if none matches
+    Move parseEpdMove(const Board &board, std::string text) {
+        std::erase_if(text, [](const char c) { return c == '+' || c == '#' || c == '!' || c == '?'; });
+        std::replace(text.begin(), text.end(), '0', 'O');
+
+        MoveList moves;
+        board.getLegalMoves(moves);
+        for (const Move move: moves) {
+            if (toSan(board, move) == text || move.toUci() == text)
+                return move;
+        }
+        return {};
+    }
+
+    struct EpdPosition {
+        std::string id;
+        std::string fen;
+        // solved by playing any of the best moves, or any move other than the avoid moves
+        std::vector<Move> bestMoves;
+        std::vector<Move> avoidMoves;
+    };
+
+    // Reads the FEN fields and the bm, am and id operations of every line. Lines
+    // without a best or avoid move that matches a legal move are reported and skipped.
+    std::vector<EpdPosition> loadEpd(const std::string &path) {
+        std::vector<EpdPosition> positions;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string placement, side, castling, enPassant;
+            if (!(fields >> placement >> side >> castling >> enPassant))
+                continue;
+
+            EpdPosition position;
+            position.fen = placement + " " + side + " " + castling + " " + enPassant + " 0 1";
+            position.id = "line " + std::to_string(positions.size() + 1);
+            const Board board(position.fen);
+
+            std::string operations;
+            std::getline(fields, operations);
+            std::istringstream list(operations);
+            std::string operation;
+            while (std::getline(list, operation, ';')) {
+                std::istringstream words(operation);
+                std::string opcode, operand;
+                words >> opcode;
+                if (opcode == "id") {
+                    std::getline(words >> std::ws, operand);
+                    position.id = operand.size() >= 2 && operand.front() == '"' ? operand.substr(1, operand.size() - 2) : operand;
+                    continue;
+                }
+                while ((opcode == "bm" || opcode == "am") && words >> operand) {
+                    const Move move = parseEpdMove(board, operand);
+                    if (!move.isNull())
+                        (opcode == "bm" ? position.bestMoves : position.avoidMoves).push_back(move);
+                }
+            }
+
+            if (position.bestMoves.empty() && position.avoidMoves.empty()) {
+                std::cout << "skipping " << position.id << ", no legal bm or am move" << std::endl;
+                continue;
+            }
+            positions.push_back(std::move(position));
+        }
+        return positions;
+    }
+
+    bool isSolution(const EpdPosition &position, const Move move) {
+        if (!position.bestMoves.empty())
+            return std::find(position.bestMoves.begin(), position.bestMoves.end(), move) != position.bestMoves.end();
+        return std::find(position.avoidMoves.begin(), position.avoidMoves.end(), move) == position.avoidMoves.end();
+    }
+
+    /**
+     * @brief Run an EPD test suite with a fixed time or node budget per position, for 1 up to N threads
+     *
+     * A position counts as solved when the final best move is a solution, and
+     * its time to solution is when the best move became one and stayed one.
+     *
+     * @return int 0 when the suite could be read, 1 otherwise
+     */
+    int runEpd(const int argc, char *argv[]) {
+        std::string path;
+        SearchLimits limits;
+        limits.moveTime = std::chrono::milliseconds(1000);
+        int maxThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+        size_t hashMegabytes = TranspositionTable::DefaultMegabytes;
+
+        for (int i = 2; i < argc; i++) {
+            if (!std::strcmp(argv[i], "--movetime") && i + 1 < argc) {
+                limits.moveTime = std::chrono::milliseconds(std::stoll(argv[++i]));
+            } else if (!std::strcmp(argv[i], "--nodes") && i + 1 < argc) {
+                limits.maxNodes = std::stoull(argv[++i]);
+                limits.moveTime = std::chrono::milliseconds::max();
+            } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+                maxThreads = std::max(std::stoi(argv[++i]), 1);
+            } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+                hashMegabytes = std::stoul(argv[++i]);
+            } else if (argv[i][0] != '-' && path.empty()) {
+                path = argv[i];
+            } else {
+                std::cout << "usage: chesscli epd FILE [--movetime MS | --nodes N] [--threads N] [--hash MB]"
+                          << std::endl;
+                return 1;
+            }
+        }
+
+        const auto positions = loadEpd(path);
+        if (positions.empty()) {
+            std::cout << "no positions in " << (path.empty() ? "(none given)" : path) << std::endl;
+            return 1;
+        }
+
+        // doubling thread counts, always ending with the maximum
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2)
+            threadCounts.push_back(threads);
+        threadCounts.push_back(maxThreads);
+
+        for (const int threads: threadCounts) {
+            limits.threads = threads;
+            int solved = 0;
+            double totalSolveTime = 0;
+            uint64_t totalSolveNodes = 0;
+
+            std::cout << "\nthreads " << threads << std::endl;
+            for (const auto &position: positions) {
+                // a fresh table per position, so earlier positions cannot help
+                Search search(hashMegabytes);
+                std::chrono::milliseconds solvedAt(-1);
+                uint64_t solvedNodes = 0;
+                search.setInfoCallback([&](const SearchInfo &info) {
+                    if (!isSolution(position, info.pv[0])) {
+                        solvedAt = std::chrono::milliseconds(-1);
+                    } else if (solvedAt.count() < 0) {
+                        solvedAt = info.elapsed;
+                        solvedNodes = info.nodes;
+                    }
+                });
+
+                const Move best = search.findBestMove(Board(position.fen), limits);
+                const bool found = isSolution(position, best) && solvedAt.count() >= 0;
+                std::cout << "  " << position.id << " " << (found ? "solved" : "FAILED") << " bestmove "
+                          << best.toUci();
+                if (found) {
+                    solved++;
+                    totalSolveTime += static_cast<double>(solvedAt.count());
+                    totalSolveNodes += solvedNodes;
+                    std::cout << " after " << solvedAt.count() << "ms " << solvedNodes << " nodes";
+                }
+                std::cout << std::endl;
+            }
+
+            std::cout << "threads " << threads << " solved " << solved << "/" << positions.size();
+            if (solved > 0)
+                std::cout << " mean time to solution " << totalSolveTime / solved << "ms, "
+                          << totalSolveNodes / solved << " nodes";
+            std::cout << std::endl;
+        }
+
+        return 0;
+    }
+    /**
+     * @brief Search one position for its best moves, printing every line of every iteration
+     *
+     * Moves given after --searchmoves, up to the next option, restrict the root.
+     *
+     * @return int 0 when there was a legal move to search, 1 otherwise
+     */
+    int runAnalyse(const int argc, char *argv[]) {
+        std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+        SearchLimits limits;
+        limits.moveTime = std::chrono::milliseconds(2000);
+        std::vector<std::string> searchMoves;
+
+        for (int i = 2; i < argc; i++) {
+            if (!std::strcmp(argv[i], "--fen") && i + 1 < argc) {
+                fen = argv[++i];
+            } else if (!std::strcmp(argv[i], "--multipv") && i + 1 < argc) {
+                limits.multiPv = std::stoi(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--depth") && i + 1 < argc) {
+                limits.maxDepth = std::stoi(argv[++i]);
+                limits.moveTime = std::chrono::milliseconds::max();
+            } else if (!std::strcmp(argv[i], "--movetime") && i + 1 < argc) {
+                limits.moveTime = std::chrono::milliseconds(std::stoll(argv[++i]));
+            } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+                limits.threads = std::stoi(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--searchmoves")) {
+                while (i + 1 < argc && argv[i + 1][0] != '-')
+                    searchMoves.emplace_back(argv[++i]);
+            } else {
+                std::cout << "usage: chesscli analyse [--fen FEN] [--multipv K] [--searchmoves MOVE...] "
+                             "[--depth D | --movetime MS] [--threads N]" << std::endl;
+                return 1;
+            }
+        }
+
+        const Board board(fen);
+        for (const auto &uci: searchMoves) {
+            if (limits.searchMoves.size < static_cast<int>(limits.searchMoves.moves.size()))
+                limits.searchMoves.push(Move::fromUci(uci));
+        }
+
+        Search search;
+        search.setInfoCallback([](const SearchInfo &info) {
+            std::cout << "info depth " << info.depth << " multipv " << info.multiPv << " score cp " << info.score
+                      << " nodes " << info.nodes << " time " << info.elapsed.count()
+                      << " pv " << info.pv.toString() << "\n";
+        });
+        const Move best = search.findBestMove(board, limits);
+        std::cout << "bestmove " << best.toUci() << std::endl;
+        return best.isNull() ? 1 : 0;
+    }
+
+    struct MatePosition {
+        const char *fen;
+        int moves;
+        // whether the mate only takes checks
+        bool checks;
+    };
+
+    // forced mates with their known lengths, the fourth takes alpha-beta seconds to see
+    const MatePosition MatePositions[] = {
+        {"r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2, true},
+        {"r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1", 3, true},
+        {"1k5r/pP3ppp/3p2b1/1BN1n3/1Q2P3/P1B5/KP3P1P/7q w - - 1 1", 3, true},
+        {"6r1/p3p1rk/1p1pPp1p/q3n2R/4P3/3BR2P/PPP2QP1/7K w - - 0 1", 5, true},
+        {"8/8/8/4k3/8/8/8/KQ6 w - - 0 1", 9, false},
+    };
+
+    // the natural capture of the knight walks into a back-rank mate
+    constexpr const char *RefutedFen = "4r1k1/3n1ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1";
+
+    /**
+     * @brief Refute the best move of each iteration from the info callback, as the search's mate solver does
+     *
+     * @return bool True when the search started over without the first refuted move and played another one
+     */
+    bool checkRefutation(MateSolver &solver) {
+        const Board board(RefutedFen);
+        Search search(1);
+        SearchLimits limits;
+        limits.maxDepth = 4;
+        MateLimits mateLimits;
+        mateLimits.maxMoves = 2;
+
+        Move refuted;
+        int restarts = 0;
+        search.setInfoCallback([&](const SearchInfo &info) {
+            if (!refuted.isNull()) {
+                restarts += info.depth == 1;
+                return;
+            }
+            Board reply = board;
+            reply.makeMove(info.pv.bestMove());
+            if (solver.solve(reply, mateLimits) == MateStatus::PROVEN) {
+                refuted = info.pv.bestMove();
+                search.refute(refuted);
+            }
+        });
+        const Move best = search.findBestMove(board, limits);
+
+        std::cout << "refute " << RefutedFen << "\n  ";
+        if (refuted.isNull())
+            std::cout << "no refutation found";
+        else
+            std::cout << refuted.toUci() << " refuted, " << restarts << " restart, played " << best.toUci();
+        std::cout << " at depth " << search.getDepth() << std::endl;
+        return !refuted.isNull() && restarts == 1 && best != refuted && search.getDepth() == limits.maxDepth;
+    }
+
+    // xorshift64*, enough to find magics and deterministic across platforms
+    class Prng {
+    public:
+        explicit Prng(const uint64_t seed) : mState(seed) {}
+
+        uint64_t next() {
+            mState ^= mState >> 12;
+            mState ^= mState << 25;
+            mState ^= mState >> 27;
+            return mState * 2685821657736338717ULL;
+        }
+
+        // few bits set, which is what good magics tend to look like
+        uint64_t sparse() { return next() & next() & next(); }
+
+    private:
+        uint64_t mState;
+    };
+
+    // per rank seeds that find every magic after a few thousand tries
+    constexpr uint64_t MagicSeeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    // try sparse candidates until one maps every subset of the mask to a slot holding the same attacks
+    Bitboard findMagic(const Sliders::Entry &entry, const int square, const Attacks::Direction (&directions)[4]) {
+        Bitboard occupancies[4096], reference[4096], slots[4096];
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            occupancies[size] = subset;
+            reference[size] = 0;
+            for (const Attacks::Direction direction: directions)
+                reference[size] |= Attacks::rayAttacks(direction, square, subset);
+            size++;
+            subset = (subset - entry.mask) & entry.mask;
+        } while (subset);
+
+        // slots written in an earlier attempt count as empty
+        int epoch[4096] = {}, attempt = 0;
+        Prng prng(MagicSeeds[rankOf(square)]);
+        Bitboard magic;
+        for (int i = 0; i < size;) {
+            do {
+                magic = prng.sparse();
+            } while (popCount((magic * entry.mask) >> 56) < 6);
+
+            attempt++;
+            for (i = 0; i < size; i++) {
+                const Bitboard slot = (occupancies[i] * magic) >> entry.shift;
+                if (epoch[slot] < attempt) {
+                    epoch[slot] = attempt;
+                    slots[slot] = reference[i];
+                } else if (slots[slot] != reference[i]) {
+                    break;
+                }
+            }
+        }
+        return magic;
+    }
+
+    /**
+     * @brief Search for the slider magics from their seeds and print them as Sliders.cpp declares them
+     *
+     * @return int 0 when they are the magics the engine was built with, 1 otherwise
+     */
+    int runMagics() {
+        constexpr Attacks::Direction BishopDirections[4] = {
+            Attacks::NORTH_EAST, Attacks::NORTH_WEST, Attacks::SOUTH_EAST, Attacks::SOUTH_WEST
+        };
+        constexpr Attacks::Direction RookDirections[4] = {
+            Attacks::NORTH, Attacks::EAST, Attacks::SOUTH, Attacks::WEST
+        };
+        const struct {
+            const char *name;
+            const std::array<Sliders::Entry, 64> &entries;
+            const Attacks::Direction (&directions)[4];
+        } pieces[] = {{"BishopMagics", Sliders::Bishop, BishopDirections}, {"RookMagics", Sliders::Rook, RookDirections}};
+
+        bool matches = true;
+        for (const auto &piece: pieces) {
+            std::cout << "constexpr Bitboard " << piece.name << "[64] = {";
+            for (int square = 0; square < 64; square++) {
+                const Bitboard magic = findMagic(piece.entries[square], square, piece.directions);
+                matches &= magic == piece.entries[square].magic;
+                std::cout << (square % 4 ? " " : "\n    ") << "0x" << std::hex << std::setw(16) << std::setfill('0')
+                          << magic << std::dec << "ULL" << (square < 63 ? "," : "");
+            }
+            std::cout << "\n};\n";
+        }
+        std::cout << (matches ? "same as the built-in magics" : "DIFFERENT from the built-in magics") << std::endl;
+        return matches ? 0 : 1;
+    }
+
+    /**
+     * @brief Look for forced mates with the proof-number solver, in a fen or in positions with known mates
+     *
+     * @return int 0 when the fen has a mate, or every known mate within reach was found at its length and the
+     *             search gave up the move refuted in checkRefutation, 1 otherwise
+     */
+    int runMate(const int argc, char *argv[]) {
+        MateLimits limits;
+        limits.maxMoves = 10;
+        size_t hashMegabytes = 64;
+        std::vector<MatePosition> positions;
+
+        for (int i = 2; i < argc; i++) {
+            if (!std::strcmp(argv[i], "--fen") && i + 1 < argc) {
+                positions.push_back({argv[++i], 0, false});
+            } else if (!std::strcmp(argv[i], "--movetime") && i + 1 < argc) {
+                limits.moveTime = std::chrono::milliseconds(std::stoll(argv[++i]));
+            } else if (!std::strcmp(argv[i], "--nodes") && i + 1 < argc) {
+                limits.maxNodes = std::stoull(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+                hashMegabytes = std::stoul(argv[++i]);
+            } else if (!std::strcmp(argv[i], "--checks")) {
+                limits.checksOnly = true;
+            } else if (argv[i][0] != '-') {
+                limits.maxMoves = std::clamp(std::stoi(argv[i]), 1, MateSolver::MaxMoves);
+            } else {
+                std::cout << "usage: chesscli mate [N] [--fen FEN] [--movetime MS] [--nodes N] [--checks] [--hash MB]"
+                          << std::endl;
+                return 1;
+            }
+        }
+        const bool known = positions.empty();
+        if (known)
+            positions.assign(std::begin(MatePositions), std::end(MatePositions));
+
+        MateSolver solver(hashMegabytes);
+        bool solved = true;
+        for (const auto &position: positions) {
+            const auto start = std::chrono::steady_clock::now();
+            const MateStatus status = solver.solve(Board(position.fen), limits);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+
+            std::cout << "mate " << limits.maxMoves << " " << position.fen << "\n  ";
+            if (status == MateStatus::PROVEN) {
+                std::cout << "mate in " << solver.getMateMoves() << ":";
+                for (const Move move: solver.getLine())
+                    std::cout << " " << move.toUci();
+            } else if (status == MateStatus::DISPROVEN) {
+                std::cout << "no mate in " << limits.maxMoves;
+            } else {
+                std::cout << "no mate in " << solver.getMateMoves() << ", stopped";
+            }
+            std::cout << "\n  " << solver.getNodes() << " nodes " << elapsed.count() << "ms";
+            if (elapsed.count() > 0)
+                std::cout << " " << solver.getNodes() / elapsed.count() * 1000 << " nps";
+            std::cout << std::endl;
+
+            // a known mate the limits allow must come out at its length
+            const bool reachable = position.moves && position.moves <= limits.maxMoves &&
+                                   (position.checks || !limits.checksOnly);
+            if (reachable && (status != MateStatus::PROVEN || solver.getMateMoves() != position.moves)) {
+                std::cout << "  expected mate in " << position.moves << std::endl;
+                solved = false;
+            }
+            if (!position.moves && status != MateStatus::PROVEN)
+                solved = false;
+        }
+        if (known && !checkRefutation(solver))
+            solved = false;
+        return solved ? 0 : 1;
+    }
+
+    // the FEN at the start of a line, with move counters added when it has none
+    bool parseFenLine(const std::string &line, std::string &fen) {
+        std::istringstream fields(line);
+        std::string field[6];
+        int count = 0;
+        while (count < 6 && fields >> field[count])
+            count++;
+        if (count < 4 || (field[1] != "w" && field[1] != "b"))
+            return false;
+
+        fen = field[0] + " " + field[1] + " " + field[2] + " " + field[3];
+        const auto isNumber = [](const std::string &text) {
+            return !text.empty() && std::all_of(text.begin(), text.end(), [](const char c) { return c >= '0' && c <= '9'; });
+        };
+        fen += count == 6 && isNumber(field[4]) && isNumber(field[5]) ? " " + field[4] + " " + field[5] : " 0 1";
+        return true;
+    }
+
+    /**
+     * @brief Call ChessSimulator::Move on every FEN of a file or of stdin, the way the tournament does
+     *
+     * A single-threaded engine gets the positions spread over a pool of jobs,
+     * otherwise they are searched one after the other with all threads. MCTS
+     * always runs on every core, so with CHESS_ENGINE=mcts there is a single
+     * job, or the times would include the other jobs' searches. A CSV row
+     * per position goes out as soon as it is done, with the wall time of the call,
+     * and a summary of the move times follows on stderr.
+     *
+     * @return int 0 when every position had a move, 1 otherwise
+     */
+    int runBatch(const int argc, char *argv[]) {
+        std::string path;
+        std::string outputPath;
+        int moveTimeMs = 3000;
+        int threads = 1;
+        int jobs = 0;
+
+        for (int i = 2; i < argc; i++) {
+            if (!std::strcmp(argv[i], "--movetime") && i + 1 < argc) {
+                moveTimeMs = std::max(std::stoi(argv[++i]), 1);
+            } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+                threads = std::max(std::stoi(argv[++i]), 1);
+            } else if (!std::strcmp(argv[i], "--jobs") && i + 1 < argc) {
+                jobs = std::max(std::stoi(argv[++i]), 1);
+            } else if (!std::strcmp(argv[i], "--output") && i + 1 < argc) {
+                outputPath = argv[++i];
+            } else if ((argv[i][0] != '-' || !std::strcmp(argv[i], "-")) && path.empty()) {
+                path = argv[i];
+            } else {
+                std::cout << "usage: chesscli batch [FILE | -] [--movetime MS] [--threads N] [--jobs N] [--output CSV]"
+                          << std::endl;
+                return 1;
+            }
+        }
+        if (jobs == 0)
+            jobs = threads == 1 ? ThreadPool::shared().size() : 1;
+        const char *engine = std::getenv("CHESS_ENGINE");
+        if (engine && !std::strcmp(engine, "mcts") && jobs > 1) {
+            std::cerr << "CHESS_ENGINE=mcts searches one position at a time, running a single job" << std::endl;
+            jobs = 1;
+        }
+
+        std::ifstream file;
+        if (!path.empty() && path != "-") {
+            file.open(path);
+            if (!file) {
+                std::cout << "cannot read " << path << std::endl;
+                return 1;
+            }
+        }
+        std::istream &input = file.is_open() ? static_cast<std::istream &>(file) : std::cin;
+        std::ofstream csvFile;
+        if (!outputPath.empty())
+            csvFile.open(outputPath);
+        std::ostream &csv = outputPath.empty() ? std::cout : csvFile;
+
+        ChessSimulator::MoveOptions options;
+        options.threads = threads;
+        // the other jobs keep every core busy, the solver would only take time from them
+        options.mateSolver = jobs == 1;
+
+        std::mutex mutex;
+        std::vector<double> times;
+        int failed = 0;
+        csv << "index,fen,move,time_ms,depth,nodes,score" << std::endl;
+
+        const auto play = [&](const int index, const std::string &fen) {
+            const auto start = std::chrono::steady_clock::now();
+            const ChessSimulator::MoveStats stats = ChessSimulator::MoveWithStats(fen, moveTimeMs, options);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard lock(mutex);
+            times.push_back(elapsed.count());
+            failed += stats.move.empty();
+            csv << index << "," << fen << "," << stats.move << "," << std::fixed << std::setprecision(3)
+                << elapsed.count() << "," << stats.depth << "," << stats.nodes << "," << stats.score << std::endl;
+        };
+
+        // positions are queued as they are read, so a stream is searched while it still comes in
+        {
+            ThreadPool pool(jobs);
+            std::string line, fen;
+            for (int index = 0; std::getline(input, line);) {
+                if (!parseFenLine(line, fen))
+                    continue;
+                if (jobs == 1)
+                    play(index++, fen);
+                else
+                    pool.submit([&play, index = index++, fen] { play(index, fen); });
+            }
+            pool.wait();
+        }
+
+        if (times.empty()) {
+            std::cerr << "no positions read" << std::endl;
+            return 1;
+        }
+        std::sort(times.begin(), times.end());
+        const auto percentile = [&times](const int p) {
+            return times[std::min(times.size() - 1, times.size() * p / 100)];
+        };
+        std::cerr << "positions " << times.size() << " jobs " << jobs << " threads " << threads << " movetime "
+                  << moveTimeMs << "ms\n";
+        std::cerr << "move time p50 " << percentile(50) << "ms p99 " << percentile(99) << "ms max " << times.back()
+                  << "ms" << std::endl;
+        if (failed)
+            std::cerr << failed << " positions without a move" << std::endl;
+        return failed ? 1 : 0;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && !std::strcmp(argv[1], "perft"))
+        return runPerft(argc, argv);
+    if (argc > 1 && !std::strcmp(argv[1], "epd"))
+        return runEpd(argc, argv);
+    if (argc > 1 && !std::strcmp(argv[1], "analyse"))
+        return runAnalyse(argc, argv);
+    if (argc > 1 && !std::strcmp(argv[1], "batch"))
+        return runBatch(argc, argv);
+    if (argc > 1 && !std::strcmp(argv[1], "mate"))
+        return runMate(argc, argv);
+    if (argc > 1 && !std::strcmp(argv[1], "magics"))
+        return runMagics();
 
-int main() {
     Board board;
     board.printBoard();
     std::cout << "\n";
@@ -21,4 +768,52 @@ int main() {
     
     for (auto move : board.getValidMoves(board.getCurrentColor()))
         std::cout << move << "\n";
+
+    // search the position and print every completed iteration
+    Search search;
+    search.setInfoCallback([](const SearchInfo &info) {
+        std::cout << "info depth " << info.depth << " score cp " << info.score
+                  << " nodes " << info.nodes << " time " << info.elapsed.count()
+                  << " pv " << info.pv.toString() << "\n";
+    });
+
+    SearchLimits limits;
+    limits.moveTime = std::chrono::milliseconds(2000);
+    std::cout << "\n";
+    auto bestMove = search.findBestMove(board, limits);
+    std::cout << "bestmove " << bestMove.toUci() << std::endl;
+
+    // compare both ways of producing child positions on positions with castling and en passant
+    const std::pair<std::string, int> perftPositions[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+    };
+    // and both slider attack backends, when the CPU can run pext
+    const Sliders::Backend startupBackend = Sliders::backend();
+    for (const Sliders::Backend backend: {Sliders::Backend::MAGIC, Sliders::Backend::PEXT}) {
+        if (!Sliders::select(backend))
+            continue;
+
+        std::cout << "\nslider attacks: " << Sliders::backendName(backend)
+                  << (backend == startupBackend ? " (startup default)" : "") << "\n";
+        for (const auto &[fen, depth]: perftPositions) {
+            Board perftBoard(fen);
+
+            auto start = std::chrono::steady_clock::now();
+            auto makeUnmakeNodes = Perft::perft(perftBoard, depth);
+            auto makeUnmakeTime = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            auto copyMakeNodes = Perft::perftCopyMake(perftBoard, depth);
+            auto copyMakeTime = std::chrono::steady_clock::now() - start;
+
+            std::cout << "perft " << depth << " " << fen << "\n"
+                      << "  make/unmake " << makeUnmakeNodes << " nodes "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(makeUnmakeTime).count() << "ms\n"
+                      << "  copy-make   " << copyMakeNodes << " nodes "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(copyMakeTime).count() << "ms\n";
+        }
+    }
+    Sliders::select(startupBackend);
 }
@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "PackedPosition.h"
+#include "Search.h"
+
+// Self-play training data: every thread plays its own games at a fixed node
+// count per move, starting each from a few random plies, and keeps the quiet
+// positions with their search scores. Once a game ends its positions get the
+// result and go into the thread's buffer, and a full buffer is appended to the
+// packed output file under a lock, so threads almost never wait on each other
+// and memory stays at one buffer per thread.
+//
+// The output is appended to, so rerunning the same command after a stop or a
+// crash carries on with new games. Game indices continue from the file, and
+// every game's random opening is derived from its index.
+
+namespace {
+    struct Options {
+        std::string outputPath = "selfplay.pack";
+        // games to play in this run, zero until interrupted
+        uint64_t games = 0;
+        int threads = 0;
+        uint64_t nodes = 5000;
+        // random plies at the start of every game, one more every other game
+        int randomPlies = 8;
+        // openings the search thinks are decided beyond this are drawn again
+        int maxOpeningScore = 400;
+        size_t hashMegabytes = 4;
+        // records per thread before they are written
+        size_t bufferSize = 8192;
+        uint64_t seed = 1;
+        bool overwrite = false;
+    };
+
+    constexpr int MaxGamePlies = 400;
+    // both sides must agree on a decided score for this many plies in a row to end the game
+    constexpr int ResignScore = 1500;
+    constexpr int ResignPlies = 6;
+    constexpr int DrawScore = 8;
+    constexpr int DrawPlies = 12;
+    constexpr int DrawMinPly = 80;
+
+    std::atomic<bool> interrupted{false};
+
+    struct Counters {
+        std::atomic<uint64_t> games{0};
+        std::atomic<uint64_t> positions{0};
+        std::atomic<uint64_t> whiteWins{0};
+        std::atomic<uint64_t> blackWins{0};
+        std::atomic<uint64_t> draws{0};
+    };
+
+    // the one place threads meet, taken once per full buffer
+    class Output {
+    public:
+        explicit Output(PackedWriter &writer) : mWriter(writer) {}
+
+        bool write(const std::vector<PackedRecord> &records) {
+            std::lock_guard lock(mMutex);
+            return mWriter.write(records.data(), records.size()) && mWriter.flush();
+        }
+
+    private:
+        std::mutex mMutex;
+        PackedWriter &mWriter;
+    };
+
+    uint64_t splitMix(uint64_t &state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    bool isCapture(const Position &position, const Move move) {
+        if (!position.pieceOn(move.to()).isEmpty())
+            return true;
+        return move.to() == position.epSquare && (position.pawns & squareBit(move.from()));
+    }
+
+    // bare kings, or a single minor piece against a bare king
+    bool isInsufficientMaterial(const Position &position) {
+        const Bitboard heavy = position.pawns | position.orthogonals;
+        if (heavy)
+            return false;
+        return popCount(position.knights | position.diagonals) <= 1;
+    }
+
+    // three times the same position within the reversible moves
+    bool isThreefold(const std::vector<uint64_t> &keys, const int halfMove) {
+        const uint64_t key = keys.back();
+        int seen = 0;
+        const int oldest = std::max(0, static_cast<int>(keys.size()) - 1 - halfMove);
+        for (int i = static_cast<int>(keys.size()) - 1; i >= oldest; i -= 2)
+            seen += keys[i] == key;
+        return seen >= 3;
+    }
+
+    // Plays random legal moves, then checks the search does not already call the
+    // game decided. False when the random moves ran into the end of a game.
+    bool playOpening(const Options &options, Board &board, Search &search, uint64_t &random) {
+        const int plies = options.randomPlies + static_cast<int>(splitMix(random) & 1);
+        for (int ply = 0; ply < plies; ply++) {
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (moves.size == 0)
+                return false;
+            board.makeMove(moves.moves[splitMix(random) % moves.size]);
+        }
+
+        SearchLimits limits;
+        limits.maxNodes = options.nodes;
+        return !search.findBestMove(board, limits).isNull() && std::abs(search.getScore()) <= options.maxOpeningScore;
+    }
+
+    /**
+     * @brief Play one game and append its quiet positions to `records`
+     *
+     * @return uint8_t The result from white's point of view, 2 won, 1 drawn, 0 lost
+     */
+    uint8_t playGame(const Options &options, const Board &start, Search &search, const uint32_t game,
+                     std::vector<PackedRecord> &records) {
+        Board board = start;
+        SearchLimits limits;
+        limits.maxNodes = options.nodes;
+
+        std::vector<uint64_t> keys{board.getPosition().key};
+        int decidedPlies = 0, drawnPlies = 0;
+        for (int ply = 0; ply < MaxGamePlies; ply++) {
+            const Position &position = board.getPosition();
+            const bool whiteToMove = position.sideToMove == PieceColor::WHITE;
+            const bool inCheck = position.isInCheck(position.sideToMove);
+
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (moves.size == 0)
+                return !inCheck ? 1 : whiteToMove ? 0 : 2;
+            if (position.halfMove >= 100 || isInsufficientMaterial(position) || isThreefold(keys, position.halfMove))
+                return 1;
+            if (interrupted)
+                return 1;
+
+            const Move best = search.findBestMove(board, limits);
+            const int score = search.getScore();
+            const int whiteScore = whiteToMove ? score : -score;
+
+            // tactics and mates say little about the evaluation of a position
+            if (!inCheck && std::abs(score) < MATE_BOUND && best.promotion() == PieceType::EMPTY &&
+                !isCapture(position, best)) {
+                const auto clamped = static_cast<int16_t>(std::clamp(whiteScore, -32000, 32000));
+                records.push_back({PackedPosition::pack(position), clamped, 0, 0, game});
+            }
+
+            decidedPlies = std::abs(score) >= ResignScore ? decidedPlies + 1 : 0;
+            if (decidedPlies >= ResignPlies)
+                return whiteScore > 0 ? 2 : 0;
+            drawnPlies = ply >= DrawMinPly && std::abs(score) <= DrawScore ? drawnPlies + 1 : 0;
+            if (drawnPlies >= DrawPlies)
+                return 1;
+
+            board.makeMove(best);
+            keys.push_back(board.getPosition().key);
+        }
+        return 1;
+    }
+
+    void worker(const Options &options, Output &output, std::atomic<uint64_t> &nextGame, const uint64_t lastGame,
+                Counters &counters, std::atomic<bool> &failed) {
+        std::vector<PackedRecord> buffer;
+        buffer.reserve(options.bufferSize + MaxGamePlies);
+
+        // one search per worker, its table cleared between games so they stay
+        // independent of what the thread played before
+        Search search(options.hashMegabytes);
+        while (!interrupted && !failed) {
+            const uint64_t game = nextGame++;
+            if (game >= lastGame)
+                break;
+
+            search.newGame();
+            uint64_t random = options.seed ^ (game * 0xD1B54A32D192ED03ULL);
+            Board board;
+            while (!playOpening(options, board, search, random))
+                board = Board();
+
+            const size_t first = buffer.size();
+            const uint8_t result = playGame(options, board, search, static_cast<uint32_t>(game), buffer);
+            // an unfinished game has no result to learn from
+            if (interrupted) {
+                buffer.resize(first);
+                break;
+            }
+            for (size_t i = first; i < buffer.size(); i++)
+                buffer[i].result = result;
+
+            counters.games++;
+            counters.positions += buffer.size() - first;
+            (result == 2 ? counters.whiteWins : result == 0 ? counters.blackWins : counters.draws)++;
+
+            if (buffer.size() >= options.bufferSize) {
+                if (!output.write(buffer))
+                    failed = true;
+                buffer.clear();
+            }
+        }
+
+        if (!buffer.empty() && !output.write(buffer))
+            failed = true;
+    }
+
+    // one past the highest game index in the file, so a resumed run plays new openings
+    uint64_t nextGameIndex(const std::string &path) {
+        PackedFile file;
+        if (!PackedFile::isPackedFile(path) || !file.open(path))
+            return 0;
+        uint64_t next = 0;
+        for (const PackedRecord &record: file)
+            next = std::max<uint64_t>(next, record.game + 1ULL);
+        return next;
+    }
+
+    void printUsage() {
+        std::cout << "usage: chessgen [--output FILE] [--games N] [--threads N] [--nodes N] [--random-plies N] "
+                     "[--hash MB] [--buffer RECORDS] [--seed N] [--overwrite]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--output") && i + 1 < argc) {
+            options.outputPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--games") && i + 1 < argc) {
+            options.games = std::stoull(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--nodes") && i + 1 < argc) {
+            options.nodes = std::max<uint64_t>(std::stoull(argv[++i]), 1);
+        } else if (!std::strcmp(argv[i], "--random-plies") && i + 1 < argc) {
+            options.randomPlies = std::max(std::stoi(argv[++i]), 0);
+        } else if (!std::strcmp(argv[i], "--hash") && i + 1 < argc) {
+            options.hashMegabytes = std::stoul(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--buffer") && i + 1 < argc) {
+            options.bufferSize = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--overwrite")) {
+            options.overwrite = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.threads <= 0)
+        options.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    const uint64_t firstGame = options.overwrite ? 0 : nextGameIndex(options.outputPath);
+    PackedWriter writer;
+    if (!writer.open(options.outputPath, !options.overwrite)) {
+        std::cout << writer.error() << std::endl;
+        return 1;
+    }
+    const size_t existing = writer.size();
+    const uint64_t lastGame = options.games ? firstGame + options.games : UINT32_MAX;
+
+    std::cout << "Output          : " << options.outputPath << " (" << existing << " positions, next game "
+              << firstGame << ")\n";
+    std::cout << "Threads         : " << options.threads << "\n";
+    std::cout << "Nodes per move  : " << options.nodes << std::endl;
+
+    // a first Ctrl-C finishes cleanly, writing every completed game
+    std::signal(SIGINT, [](int) { interrupted = true; });
+
+    Output output(writer);
+    Counters counters;
+    std::atomic<uint64_t> nextGame{firstGame};
+    std::atomic<bool> failed{false};
+    std::atomic<int> running{options.threads};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < options.threads; t++) {
+        workers.emplace_back([&] {
+            worker(options, output, nextGame, lastGame, counters, failed);
+            running--;
+        });
+    }
+
+    auto lastReport = start;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const bool done = running == 0;
+        const auto now = std::chrono::steady_clock::now();
+        if (!done && now - lastReport < std::chrono::seconds(10))
+            continue;
+        lastReport = now;
+
+        const std::chrono::duration<double> elapsed = now - start;
+        std::cout << "games " << counters.games << " positions " << counters.positions << " positions/s "
+                  << static_cast<uint64_t>(static_cast<double>(counters.positions) / elapsed.count()) << " W/D/L "
+                  << counters.whiteWins << "/" << counters.draws << "/" << counters.blackWins << std::endl;
+        if (done)
+            break;
+    }
+    for (auto &thread: workers)
+        thread.join();
+
+    writer.close();
+    if (failed) {
+        std::cout << writer.error() << std::endl;
+        return 1;
+    }
+    std::cout << "Positions in " << options.outputPath << ": " << writer.size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include "Simulation.h"
+
+#include <algorithm>
+
+#include "chess-simulator.h"
+#include "magic_enum/magic_enum.hpp"
+
+Simulation::~Simulation() {
+  stop();
+  // the stopped boards end their searches within a few milliseconds
+  for (auto &slot : mRetired)
+    slot->thread.join();
+}
+
+void Simulation::start(const Settings &settings) {
+  stop();
+
+  mSettings = settings;
+  mSettings.games = std::max(mSettings.games, 1);
+  mSettings.boards = std::clamp(mSettings.boards, 1, mSettings.games);
+  mSettings.moveTimeMs = std::max(mSettings.moveTimeMs, 1);
+  {
+    std::lock_guard lock(mMutex);
+    mRunning = false;
+    mStartedGames = 0;
+    mWhiteWins = mBlackWins = mDraws = 0;
+  }
+
+  for (int i = 0; i < mSettings.boards; i++) {
+    auto slot = std::make_unique<Slot>();
+    slot->moveTimeMs = mSettings.moveTimeMs;
+    slot->singleBoard = mSettings.boards == 1;
+    slot->game.number = nextGameNumber(*slot);
+    mSlots.push_back(std::move(slot));
+  }
+  for (auto &slot : mSlots) {
+    slot->thread = std::thread([this, &slot = *slot] {
+      play(slot);
+      slot.finished = true;
+    });
+  }
+}
+
+void Simulation::stop() {
+  {
+    std::lock_guard lock(mMutex);
+    for (auto &slot : mSlots)
+      slot->stopped = true;
+  }
+  mWake.notify_all();
+
+  // the boards finish their moves in the background, this runs on the render thread
+  for (auto &slot : mSlots)
+    mRetired.push_back(std::move(slot));
+  mSlots.clear();
+  joinFinished();
+}
+
+void Simulation::joinFinished() {
+  auto finished = std::stable_partition(
+      mRetired.begin(), mRetired.end(),
+      [](const std::unique_ptr<Slot> &slot) { return !slot->finished; });
+  for (auto it = finished; it != mRetired.end(); ++it)
+    (*it)->thread.join();
+  mRetired.erase(finished, mRetired.end());
+}
+
+void Simulation::setRunning(bool running) {
+  {
+    std::lock_guard lock(mMutex);
+    mRunning = running;
+  }
+  mWake.notify_all();
+}
+
+bool Simulation::isRunning() const {
+  std::lock_guard lock(mMutex);
+  return mRunning;
+}
+
+void Simulation::step() {
+  {
+    std::lock_guard lock(mMutex);
+    mRunning = false;
+    mStepGeneration++;
+  }
+  mWake.notify_all();
+}
+
+void Simulation::setMovesPerSecond(float movesPerSecond) {
+  {
+    std::lock_guard lock(mMutex);
+    mMovesPerSecond = std::max(movesPerSecond, 0.0f);
+  }
+  mWake.notify_all();
+}
+
+Game Simulation::game(int board) const {
+  const Slot &slot = *mSlots[board];
+  std::lock_guard lock(slot.mutex);
+  return slot.game;
+}
+
+chess::Board Simulation::position(int board) const {
+  const Slot &slot = *mSlots[board];
+  std::lock_guard lock(slot.mutex);
+  return slot.game.board;
+}
+
+int Simulation::finishedGames() const {
+  std::lock_guard lock(mMutex);
+  return mWhiteWins + mBlackWins + mDraws;
+}
+
+int Simulation::whiteWins() const {
+  std::lock_guard lock(mMutex);
+  return mWhiteWins;
+}
+
+int Simulation::blackWins() const {
+  std::lock_guard lock(mMutex);
+  return mBlackWins;
+}
+
+int Simulation::draws() const {
+  std::lock_guard lock(mMutex);
+  return mDraws;
+}
+
+void Simulation::play(Slot &slot) {
+  using Clock = std::chrono::steady_clock;
+
+  uint64_t seenStep;
+  {
+    std::lock_guard lock(mMutex);
+    seenStep = mStepGeneration;
+  }
+  auto lastMove = Clock::now();
+
+  while (true) {
+    {
+      // wait until running and the next move is due, or until a step
+      std::unique_lock lock(mMutex);
+      while (true) {
+        if (slot.stopped)
+          return;
+        if (mRunning) {
+          seenStep = mStepGeneration;
+          if (mMovesPerSecond <= 0)
+            break;
+          const auto due =
+              lastMove + std::chrono::duration_cast<Clock::duration>(
+                             std::chrono::duration<float>(1 / mMovesPerSecond));
+          if (Clock::now() >= due)
+            break;
+          mWake.wait_until(lock, due);
+        } else if (seenStep != mStepGeneration) {
+          seenStep = mStepGeneration;
+          break;
+        } else {
+          mWake.wait(lock);
+        }
+      }
+    }
+    lastMove = Clock::now();
+
+    if (advance(slot))
+      continue;
+
+    // the finished game stayed on the board for one move, replace it
+    const int number = nextGameNumber(slot);
+    if (!number)
+      return;
+    Game next;
+    next.number = number;
+    std::lock_guard lock(slot.mutex);
+    slot.game = std::move(next);
+  }
+}
+
+bool Simulation::advance(Slot &slot) {
+  chess::Board board;
+  {
+    std::lock_guard lock(slot.mutex);
+    if (!slot.game.result.empty())
+      return false;
+    board = slot.game.board;
+  }
+
+  // the winner, if any, is the side that just moved
+  std::string result;
+  bool drawn = false;
+  if (board.isHalfMoveDraw()) {
+    auto type = board.getHalfMoveDrawType();
+    result = std::string(magic_enum::enum_name(type.second)) + " " +
+             std::string(magic_enum::enum_name(type.first));
+    drawn = true;
+  } else {
+    auto type = board.isGameOver();
+    if (type.second != chess::GameResult::NONE ||
+        type.first != chess::GameResultReason::NONE) {
+      result = std::string(magic_enum::enum_name(type.second)) + " " +
+               std::string(magic_enum::enum_name(type.first));
+      drawn = type.second != chess::GameResult::LOSE;
+    }
+  }
+
+  std::string moveStr;
+  std::chrono::nanoseconds spent = std::chrono::nanoseconds::zero();
+  if (result.empty()) {
+    ChessSimulator::MoveOptions options;
+    options.stop = &slot.stopped;
+    options.threads = slot.singleBoard ? 0 : 1;
+    options.mateSolver = slot.singleBoard;
+    const auto beforeTime = std::chrono::high_resolution_clock::now();
+    moveStr = ChessSimulator::MoveWithStats(board.getFen(true), slot.moveTimeMs,
+                                            options)
+                  .move;
+    spent = std::chrono::high_resolution_clock::now() - beforeTime;
+    // an engine without an answer loses, rather than stalling the board
+    if (moveStr.empty())
+      result = "NO MOVE";
+  }
+
+  if (!result.empty()) {
+    {
+      // a board of an ended run must not count towards the next one
+      std::lock_guard lock(mMutex);
+      if (slot.stopped)
+        return true;
+      if (drawn)
+        mDraws++;
+      else if (board.sideToMove().internal() ==
+               chess::Color::underlying::WHITE)
+        mBlackWins++;
+      else
+        mWhiteWins++;
+    }
+    std::lock_guard lock(slot.mutex);
+    slot.game.result = result;
+    return true;
+  }
+
+  std::string turn(magic_enum::enum_name(board.sideToMove().internal()));
+  board.makeMove(chess::uci::uciToMove(board, moveStr));
+
+  std::lock_guard lock(slot.mutex);
+  slot.game.board = board;
+  slot.game.timeSpentOnMoves += spent;
+  slot.game.timeSpentLastMove = spent;
+  slot.game.moves.push_back(std::to_string(board.fullMoveNumber()) + " " +
+                            turn + ": " + moveStr);
+  return true;
+}
+
+int Simulation::nextGameNumber(const Slot &slot) {
+  std::lock_guard lock(mMutex);
+  if (slot.stopped || mStartedGames >= mSettings.games)
+    return 0;
+  return ++mStartedGames;
+}
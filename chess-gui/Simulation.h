@@ -0,0 +1,121 @@
+#ifndef CHESS_COMPETITION_SIMULATION_H
+#define CHESS_COMPETITION_SIMULATION_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chess.hpp"
+
+// A game the engine plays against itself
+struct Game {
+  chess::Board board;
+  // "<move number> <side>: <uci>", oldest first
+  std::vector<std::string> moves;
+  // empty while the game goes on
+  std::string result;
+  // counted from 1 over the whole run
+  int number = 0;
+  std::chrono::nanoseconds timeSpentOnMoves = std::chrono::nanoseconds::zero();
+  std::chrono::nanoseconds timeSpentLastMove = std::chrono::nanoseconds::zero();
+};
+
+// Games played on threads of their own, so they advance as fast as the engine
+// answers or at a set rate instead of once per rendered frame. The renderer
+// only samples the latest positions. Each board plays games one after another
+// until the run has played the requested number.
+//
+// Ending a run never waits for its boards: they are told to stop, cut the move
+// they are searching short and finish in the background, so the window stays
+// responsive on Reset. Only the destructor joins them.
+class Simulation {
+public:
+  struct Settings {
+    // games played at the same time, one thread each
+    int boards = 1;
+    // games played over the whole run
+    int games = 1;
+    // engine time per move, the competition allows a few seconds
+    int moveTimeMs = 3000;
+  };
+
+  ~Simulation();
+
+  // stops the current run and starts a new one, paused
+  void start(const Settings &settings);
+
+  // ends the run without waiting for the moves in progress
+  void stop();
+
+  void setRunning(bool running);
+  bool isRunning() const;
+
+  // while paused, plays one move on every board
+  void step();
+
+  // moves per second on each board, zero for as fast as the engine answers
+  void setMovesPerSecond(float movesPerSecond);
+
+  int boardCount() const { return static_cast<int>(mSlots.size()); }
+
+  // a copy of the game on a board, safe to take while the games run
+  Game game(int board) const;
+
+  // only the position, cheaper than game() for drawing many boards
+  chess::Board position(int board) const;
+
+  int finishedGames() const;
+  int whiteWins() const;
+  int blackWins() const;
+  int draws() const;
+
+private:
+  struct Slot {
+    mutable std::mutex mutex;
+    Game game;
+    std::thread thread;
+    int moveTimeMs = 0;
+    // a single board searches on every core and leaves one to the mate
+    // solver, several boards take a core each
+    bool singleBoard = true;
+    // set under mMutex when the run ends, also stops the search of the move in progress
+    std::atomic<bool> stopped{false};
+    // the thread has returned, joining it will not block
+    std::atomic<bool> finished{false};
+  };
+
+  void play(Slot &slot);
+
+  // plays a move or records the result, false once the result is on the board
+  bool advance(Slot &slot);
+
+  // the game a board plays next, zero once the run has played them all or the board was stopped
+  int nextGameNumber(const Slot &slot);
+
+  // joins the boards of earlier runs whose threads have returned
+  void joinFinished();
+
+  Settings mSettings;
+  std::vector<std::unique_ptr<Slot>> mSlots;
+  // boards of ended runs, until their threads return
+  std::vector<std::unique_ptr<Slot>> mRetired;
+
+  // guards everything below
+  mutable std::mutex mMutex;
+  std::condition_variable mWake;
+  bool mRunning = false;
+  // bumped by step(), each board plays a move when it sees a new value
+  uint64_t mStepGeneration = 0;
+  float mMovesPerSecond = 0;
+  int mStartedGames = 0;
+  int mWhiteWins = 0;
+  int mBlackWins = 0;
+  int mDraws = 0;
+};
+
+#endif // CHESS_COMPETITION_SIMULATION_H
@@ -1,6 +1,9 @@
 
 #define SDL_MAIN_HANDLED true
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 #include "SDL_image.h"
@@ -20,113 +23,233 @@ EM_JS(int, canvas_get_width, (), { return canvas.width; });
 EM_JS(int, canvas_get_height, (), { return canvas.height; });
 #endif
 
-#include "chess-simulator.h"
 #include "chess.hpp"
 
 #include "PieceSvg.h"
-#include "magic_enum/magic_enum.hpp"
+#include "Simulation.h"
 #include <chrono>
-#include <map>
+#include <cmath>
+#include <vector>
+
+// Pieces rasterised from their SVGs at the size of a square, so they are
+// copied pixel for pixel instead of stretched. Redone when the size changes.
+// Every board on screen has the same square size and shares them.
+class PieceTextures {
+public:
+  ~PieceTextures() { destroy(); }
+
+  // the textures are gone, e.g. after the renderer lost its device
+  void invalidate() { rasterisedSize = 0; }
+
+  // must run before the renderer is destroyed
+  void destroy() {
+    for (auto &texture : textures) {
+      if (texture)
+        SDL_DestroyTexture(texture);
+      texture = nullptr;
+    }
+    rasterisedSize = 0;
+  }
+
+  // true when the pieces had to be rasterised again
+  bool prepare(SDL_Renderer *renderer, int size) {
+    if (size == rasterisedSize)
+      return false;
+    rasterise(renderer, size);
+    rasterisedSize = size;
+    return true;
+  }
+
+  // null for an empty square
+  SDL_Texture *get(chess::Piece piece) const {
+    const auto index = static_cast<size_t>(piece.internal());
+    return index < textures.size() ? textures[index] : nullptr;
+  }
+
+private:
+  void rasterise(SDL_Renderer *renderer, int size) {
+    using Piece = chess::Piece::underlying;
+    const std::pair<Piece, const char *> svgs[] = {
+        {Piece::WHITEPAWN, PawnWhiteSvgString},
+        {Piece::BLACKPAWN, PawnBlackSvgString},
+        {Piece::WHITEKNIGHT, KnightWhiteSvgString},
+        {Piece::BLACKKNIGHT, KnightBlackSvgString},
+        {Piece::WHITEBISHOP, BishopWhiteSvgString},
+        {Piece::BLACKBISHOP, BishopBlackSvgString},
+        {Piece::WHITEROOK, RookWhiteSvgString},
+        {Piece::BLACKROOK, RookBlackSvgString},
+        {Piece::WHITEQUEEN, QueenWhiteSvgString},
+        {Piece::BLACKQUEEN, QueenBlackSvgString},
+        {Piece::WHITEKING, KingWhiteSvgString},
+        {Piece::BLACKKING, KingBlackSvgString},
+    };
+
+    destroy();
+    for (const auto &[piece, svg] : svgs) {
+      SDL_RWops *rw = SDL_RWFromConstMem(svg, static_cast<int>(strlen(svg)));
+      SDL_Surface *surface = IMG_LoadSizedSVG_RW(rw, size, size);
+      SDL_RWclose(rw);
+      if (!surface) {
+        SDL_Log("Error rasterising piece: %s", IMG_GetError());
+        continue;
+      }
+      textures[static_cast<int>(piece)] =
+          SDL_CreateTextureFromSurface(renderer, surface);
+      SDL_FreeSurface(surface);
+    }
+  }
 
-enum class SimulationState {
-  PAUSED,
-  RUNNING,
+  // indexed by chess::Piece::underlying, NONE included
+  std::array<SDL_Texture *, 13> textures{};
+  int rasterisedSize = 0;
 };
 
-// ui settings
-auto simulationState = SimulationState::PAUSED;
-std::chrono::nanoseconds timeSpentOnMoves = std::chrono::nanoseconds::zero();
-std::chrono::nanoseconds timeSpentLastMove = std::chrono::milliseconds::zero();
-string gameResult;
-vector<string> moves;
-
-void reset(chess::Board &board) {
-  board = chess::Board();
-  simulationState = SimulationState::PAUSED;
-  timeSpentOnMoves = std::chrono::nanoseconds::zero();
-  timeSpentLastMove = std::chrono::milliseconds::zero();
-  gameResult = "";
-  moves.clear();
-}
+// A board kept in a render target texture. A frame only redraws the squares
+// whose piece changed since the last one and then copies the whole texture, so
+// watching a game costs one copy per frame instead of 64 fills and copies.
+class BoardView {
+public:
+  BoardView() = default;
+  BoardView(BoardView &&other) noexcept { *this = std::move(other); }
+  BoardView &operator=(BoardView &&other) noexcept {
+    std::swap(target, other.target);
+    side = other.side;
+    drawn = other.drawn;
+    valid = other.valid;
+    redrawn = other.redrawn;
+    return *this;
+  }
+  ~BoardView() {
+    if (target)
+      SDL_DestroyTexture(target);
+  }
 
-void move(chess::Board &board) {
-  if (board.isHalfMoveDraw()) {
-    auto result = board.getHalfMoveDrawType();
-    gameResult = std::string(magic_enum::enum_name(result.second)) + " " +
-                 std::string(magic_enum::enum_name(result.first));
-    return;
+  // the texture contents are gone, e.g. after the renderer reset its targets
+  void invalidate(bool texturesLost) {
+    valid = false;
+    if (texturesLost)
+      side = 0;
   }
-  auto result = board.isGameOver();
-  if (result.second != chess::GameResult::NONE ||
-      result.first != chess::GameResultReason::NONE) {
-    gameResult = std::string(magic_enum::enum_name(result.second)) + " " +
-                 std::string(magic_enum::enum_name(result.first));
-    simulationState = SimulationState::PAUSED;
-    return;
+
+  // squares redrawn by the last draw, 64 after a resize and few during a game
+  int lastRedrawn() const { return redrawn; }
+
+  // draws the board into `area`, whose side must be a multiple of 8
+  void draw(SDL_Renderer *renderer, const PieceTextures &pieces,
+            const chess::Board &board, const SDL_Rect &area) {
+    if (area.w != side)
+      resize(renderer, area.w);
+
+    // without render targets every square is drawn straight to the window
+    redrawn = 0;
+    if (!target) {
+      for (int square = 0; square < 64; square++)
+        drawSquare(renderer, pieces, board.at(chess::Square(square)), square,
+                   area);
+      redrawn = 64;
+      return;
+    }
+
+    SDL_SetRenderTarget(renderer, target);
+    const SDL_Rect local = {0, 0, area.w, area.h};
+    for (int square = 0; square < 64; square++) {
+      const auto piece = board.at(chess::Square(square));
+      if (valid && piece == drawn[square])
+        continue;
+      drawSquare(renderer, pieces, piece, square, local);
+      drawn[square] = piece;
+      redrawn++;
+    }
+    SDL_SetRenderTarget(renderer, nullptr);
+    valid = true;
+
+    SDL_RenderCopy(renderer, target, nullptr, &area);
   }
 
-  std::string turn(magic_enum::enum_name(board.sideToMove().internal()));
-  // get stats
-  auto beforeTime = std::chrono::high_resolution_clock::now();
-
-  // run!
-  auto moveStr = ChessSimulator::Move(board.getFen(true));
-  // get stats
-  auto afterTime = std::chrono::high_resolution_clock::now();
-  // apply move
-  auto move = chess::uci::uciToMove(board, moveStr);
-  board.makeMove(move);
-
-  // update stats
-  timeSpentOnMoves += afterTime - beforeTime;
-  timeSpentLastMove = afterTime - beforeTime;
-  moves.push_back(std::to_string(board.fullMoveNumber()) + " " + turn + ": " +
-                  moveStr);
-}
+private:
+  void resize(SDL_Renderer *renderer, int newSide) {
+    if (target)
+      SDL_DestroyTexture(target);
+    target = nullptr;
+    if (SDL_RenderTargetSupported(renderer))
+      target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                 SDL_TEXTUREACCESS_TARGET, newSide, newSide);
+    side = newSide;
+    valid = false;
+  }
 
-struct Texture {
-  SDL_Texture *texture;
-  SDL_Surface *surface;
-  ~Texture() {
-    if (texture)
-      SDL_DestroyTexture(texture);
-    if (surface)
-      SDL_FreeSurface(surface);
+  static void drawSquare(SDL_Renderer *renderer, const PieceTextures &pieces,
+                         chess::Piece piece, int square, const SDL_Rect &area) {
+    const int size = area.w / 8;
+    const int file = square % 8, rank = square / 8;
+    const SDL_Rect rect = {area.x + file * size, area.y + (7 - rank) * size,
+                           size, size};
+
+    if ((rank + file) % 2 == 0)
+      SDL_SetRenderDrawColor(renderer, 0xAA, 0xAA, 0xAA, 0xFF);
+    else
+      SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    SDL_RenderFillRect(renderer, &rect);
+
+    if (SDL_Texture *texture = pieces.get(piece))
+      SDL_RenderCopy(renderer, texture, nullptr, &rect);
   }
-};
 
-Texture *SvgStringToTexture(std::string svgString, SDL_Renderer *renderer) {
-  Texture *tex = new Texture();
-  SDL_RWops *rw = SDL_RWFromConstMem(svgString.c_str(), svgString.size());
-  // todo: check if it is correct
-  tex->surface = IMG_Load_RW(rw, 1);
-  tex->texture = SDL_CreateTextureFromSurface(renderer, tex->surface);
+  SDL_Texture *target = nullptr;
+  int side = 0;
+  // what the target currently shows
+  std::array<chess::Piece, 64> drawn{};
+  bool valid = false;
+  int redrawn = 0;
+};
 
-  return tex;
-}
-auto loadPiecesTextures(SDL_Renderer *renderer) {
-  std::map<char, Texture *> map;
-
-  map['P'] = SvgStringToTexture(PawnWhiteSvgString, renderer);
-  map['p'] = SvgStringToTexture(PawnBlackSvgString, renderer);
-  map['R'] = SvgStringToTexture(RookWhiteSvgString, renderer);
-  map['r'] = SvgStringToTexture(RookBlackSvgString, renderer);
-  map['N'] = SvgStringToTexture(KnightWhiteSvgString, renderer);
-  map['n'] = SvgStringToTexture(KnightBlackSvgString, renderer);
-  map['B'] = SvgStringToTexture(BishopWhiteSvgString, renderer);
-  map['b'] = SvgStringToTexture(BishopBlackSvgString, renderer);
-  map['Q'] = SvgStringToTexture(QueenWhiteSvgString, renderer);
-  map['q'] = SvgStringToTexture(QueenBlackSvgString, renderer);
-  map['K'] = SvgStringToTexture(KingWhiteSvgString, renderer);
-  map['k'] = SvgStringToTexture(KingBlackSvgString, renderer);
-
-  return map;
+// Where each board goes when `count` boards share the window: a grid as close
+// to square as possible, every board the same size and the grid centred.
+std::vector<SDL_Rect> tileBoards(int count, int windowWidth, int windowHeight) {
+  const int columns = static_cast<int>(std::ceil(std::sqrt(count)));
+  const int rows = (count + columns - 1) / columns;
+  const int tile = std::min(windowWidth / columns, windowHeight / rows);
+  // leave a gap between boards so they do not read as one
+  const int gap = count > 1 ? std::max(tile / 32, 2) : 0;
+  const int side = (tile - gap) / 8 * 8;
+
+  std::vector<SDL_Rect> areas;
+  if (side <= 0)
+    return areas;
+  const int left = (windowWidth - columns * tile) / 2;
+  const int top = (windowHeight - rows * tile) / 2;
+  for (int i = 0; i < count; i++)
+    areas.push_back({left + (i % columns) * tile + (tile - side) / 2,
+                     top + (i / columns) * tile + (tile - side) / 2, side,
+                     side});
+  return areas;
 }
 
 int main(int argc, char *argv[]) {
-  // Unused argc, argv
-  (void)argc;
-  (void)argv;
+  // without vsync frames are capped at maxFps instead
+  bool vsync = true;
+  int maxFps = 60;
+  Simulation::Settings settings;
+  float movesPerSecond = 0;
+  bool play = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--no-vsync"))
+      vsync = false;
+    else if (!strcmp(argv[i], "--fps") && i + 1 < argc)
+      maxFps = std::max(atoi(argv[++i]), 1);
+    else if (!strcmp(argv[i], "--boards") && i + 1 < argc)
+      settings.boards = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--games") && i + 1 < argc)
+      settings.games = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--movetime") && i + 1 < argc)
+      settings.moveTimeMs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--mps") && i + 1 < argc)
+      movesPerSecond = static_cast<float>(atof(argv[++i]));
+    else if (!strcmp(argv[i], "--play"))
+      play = true;
+  }
+  // several boards only make sense for several games
+  settings.games = std::max(settings.games, settings.boards);
 
   if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) !=
       0) {
@@ -156,15 +279,23 @@ int main(int argc, char *argv[]) {
 
   // Setup SDL_Renderer instance
   SDL_Renderer *renderer = SDL_CreateRenderer(
-      window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
+      window, -1,
+      SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE |
+          (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
   if (renderer == nullptr) {
     SDL_Log("Error creating SDL_Renderer!");
     abort();
   }
 
-  auto piecesTextures = loadPiecesTextures(renderer);
+  PieceTextures pieces;
+  std::vector<BoardView> boardViews;
+  int selectedBoard = 0;
 
-  chess::Board board;
+  // games run on their own threads, the loop below only samples them
+  Simulation simulation;
+  simulation.setMovesPerSecond(movesPerSecond);
+  simulation.start(settings);
+  simulation.setRunning(play);
 
   SDL_RendererInfo info;
   SDL_GetRendererInfo(renderer, &info);
@@ -190,8 +321,11 @@ int main(int argc, char *argv[]) {
 
   // Event loop
   while (!done) {
-    if (simulationState == SimulationState::RUNNING)
-      move(board);
+    const auto frameStart = std::chrono::steady_clock::now();
+    // nothing changes on its own while paused, sleep until there is input; a
+    // step shows up within the timeout
+    if (!simulation.isRunning())
+      SDL_WaitEventTimeout(nullptr, 250);
 
     SDL_Event event;
 
@@ -203,8 +337,21 @@ int main(int argc, char *argv[]) {
           event.window.event == SDL_WINDOWEVENT_CLOSE &&
           event.window.windowID == SDL_GetWindowID(window))
         done = true;
+      if (event.type == SDL_RENDER_TARGETS_RESET)
+        for (auto &view : boardViews)
+          view.invalidate(false);
+      if (event.type == SDL_RENDER_DEVICE_RESET) {
+        pieces.invalidate();
+        for (auto &view : boardViews)
+          view.invalidate(true);
+      }
     }
 
+    const int boardCount = simulation.boardCount();
+    if (static_cast<int>(boardViews.size()) != boardCount)
+      boardViews.resize(boardCount);
+    selectedBoard = std::clamp(selectedBoard, 0, boardCount - 1);
+
     // Start the Dear ImGui frame
     ImGui_ImplSDLRenderer_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -216,37 +363,63 @@ int main(int argc, char *argv[]) {
                 ImGui::GetIO().DeltaTime * 1000,
                 1.0f / ImGui::GetIO().DeltaTime,
                 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    int redrawn = 0;
+    for (const auto &view : boardViews)
+      redrawn += view.lastRedrawn();
+    ImGui::Text("Squares redrawn: %d", redrawn);
+    if (ImGui::Checkbox("VSync", &vsync))
+      SDL_RenderSetVSync(renderer, vsync ? 1 : 0);
+    if (!vsync) {
+      ImGui::SameLine();
+      ImGui::SliderInt("Max FPS", &maxFps, 1, 240);
+    }
+
+    // a new run takes these on Reset
+    ImGui::Separator();
+    ImGui::SliderInt("Boards", &settings.boards, 1, 64);
+    ImGui::SliderInt("Games", &settings.games, 1, 1000);
+    ImGui::SliderInt("Move time (ms)", &settings.moveTimeMs, 1, 3000);
+    if (ImGui::SliderFloat("Moves/s (0: max)", &movesPerSecond, 0, 60))
+      simulation.setMovesPerSecond(movesPerSecond);
 
     ImGui::Separator();
     if (ImGui::Button("Reset")) {
-      simulationState = SimulationState::RUNNING;
-      reset(board);
+      settings.games = std::max(settings.games, settings.boards);
+      simulation.start(settings);
     }
     ImGui::SameLine();
     if (ImGui::Button("Play")) {
-      simulationState = SimulationState::RUNNING;
+      simulation.setRunning(true);
     }
     ImGui::SameLine();
     if (ImGui::Button("Pause")) {
-      simulationState = SimulationState::PAUSED;
+      simulation.setRunning(false);
     }
     ImGui::SameLine();
     if (ImGui::Button("Step")) {
-      simulationState = SimulationState::PAUSED;
-      move(board);
+      simulation.step();
     }
     ImGui::Separator();
-    // statistics
-    ImGui::Text("Acc Time spent: %.3fms", timeSpentOnMoves.count() / 1000000.0);
+    ImGui::Text("Games: %d finished | White %d Black %d Draw %d",
+                simulation.finishedGames(), simulation.whiteWins(),
+                simulation.blackWins(), simulation.draws());
+    if (boardCount > 1)
+      ImGui::SliderInt("Board", &selectedBoard, 0, boardCount - 1);
+
+    // statistics of the selected board
+    const Game game = simulation.game(selectedBoard);
+    ImGui::Text("Game #%d", game.number);
+    ImGui::Text("Acc Time spent: %.3fms",
+                game.timeSpentOnMoves.count() / 1000000.0);
     ImGui::Text("Last move dur:  %.3fms",
-                timeSpentLastMove.count() / 1000000.0);
+                game.timeSpentLastMove.count() / 1000000.0);
 
-    ImGui::Text("Game result: %s", gameResult.c_str());
+    ImGui::Text("Game result: %s", game.result.c_str());
     // moves
     ImGui::Separator();
     ImGui::BeginChild("Moves", ImVec2(0, 0), true);
     // print moves in reverse order
-    for (auto it = moves.rbegin(); it != moves.rend(); ++it)
+    for (auto it = game.moves.rbegin(); it != game.moves.rend(); ++it)
       ImGui::Text("%s", it->c_str());
     ImGui::EndChild(); // end child moves
     ImGui::End();      // end settings
@@ -259,100 +432,53 @@ int main(int argc, char *argv[]) {
         (Uint8)(clear_color.z * 255), (Uint8)(clear_color.w * 255));
     SDL_RenderClear(renderer);
 
-    // draw the chess board
-    auto displacementX = width / 2.f - std::min(width, height) / 2.f;
-    auto displacementY = height / 2.f - std::min(width, height) / 2.f;
-    // get window size from SDL
+    // draw the latest position of every board
     int screenWidth, screenHeight;
-    SDL_GetWindowSize(window, &screenWidth, &screenHeight);
-    int minScreenSide = std::min(screenWidth, screenHeight);
-
-    for (int row = 0; row < 8; row++) {
-      for (int col = 0; col < 8; col++) {
-        SDL_Rect squareRect = {(int)(displacementX + col * minScreenSide / 8.f),
-                               (int)(screenHeight - displacementY -
-                                     (row + 1) * minScreenSide / 8.f),
-                               (int)(minScreenSide / 8.f),
-                               (int)(minScreenSide / 8.f)};
-
-        if ((row + col) % 2 == 0) {
-          SDL_SetRenderDrawColor(renderer, 0xAA, 0xAA, 0xAA, 0xFF);
-          SDL_RenderFillRect(renderer, &squareRect);
-        } else {
-          SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-          SDL_RenderFillRect(renderer, &squareRect);
-        }
-
-        switch (board.at(chess::Square(row * 8 + col)).internal()) {
-        case chess::Piece::underlying::WHITEPAWN:
-          SDL_RenderCopy(renderer, piecesTextures['P']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKPAWN:
-          SDL_RenderCopy(renderer, piecesTextures['p']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::WHITEROOK:
-          SDL_RenderCopy(renderer, piecesTextures['R']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKROOK:
-          SDL_RenderCopy(renderer, piecesTextures['r']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::WHITEKNIGHT:
-          SDL_RenderCopy(renderer, piecesTextures['N']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKKNIGHT:
-          SDL_RenderCopy(renderer, piecesTextures['n']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::WHITEBISHOP:
-          SDL_RenderCopy(renderer, piecesTextures['B']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKBISHOP:
-          SDL_RenderCopy(renderer, piecesTextures['b']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::WHITEQUEEN:
-          SDL_RenderCopy(renderer, piecesTextures['Q']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKQUEEN:
-          SDL_RenderCopy(renderer, piecesTextures['q']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::WHITEKING:
-          SDL_RenderCopy(renderer, piecesTextures['K']->texture, nullptr,
-                         &squareRect);
-          break;
-        case chess::Piece::underlying::BLACKKING:
-          SDL_RenderCopy(renderer, piecesTextures['k']->texture, nullptr,
-                         &squareRect);
-          break;
-        default:
-          break;
-        }
-      }
+    SDL_GetRendererOutputSize(renderer, &screenWidth, &screenHeight);
+    const auto areas = tileBoards(boardCount, screenWidth, screenHeight);
+    if (!areas.empty() && pieces.prepare(renderer, areas[0].w / 8))
+      for (auto &view : boardViews)
+        view.invalidate(false);
+    for (size_t i = 0; i < areas.size(); i++)
+      boardViews[i].draw(renderer, pieces,
+                         simulation.position(static_cast<int>(i)), areas[i]);
+    if (boardCount > 1 && !areas.empty()) {
+      const SDL_Rect &area = areas[selectedBoard];
+      const SDL_Rect frame = {area.x - 2, area.y - 2, area.w + 4, area.h + 4};
+      SDL_SetRenderDrawColor(renderer, 0xFF, 0xC0, 0x00, 0xFF);
+      SDL_RenderDrawRect(renderer, &frame);
     }
 
     // present ui on top of your drawings
     ImGui_ImplSDLRenderer_RenderDrawData(ImGui::GetDrawData());
     SDL_RenderPresent(renderer);
 
-    SDL_Delay(0);
+    // vsync already paces the loop, otherwise leave the rest of the frame to the engine
+    if (!vsync) {
+      const auto frameTime = std::chrono::steady_clock::now() - frameStart;
+      const auto budget = std::chrono::microseconds(1000000 / maxFps);
+      if (frameTime < budget)
+        SDL_Delay(static_cast<Uint32>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(budget -
+                                                                  frameTime)
+                .count()));
+    }
   }
 
+  simulation.stop();
+
   // Cleanup
   ImGui_ImplSDLRenderer_Shutdown();
   ImGui_ImplSDL2_Shutdown();
   ImGui::DestroyContext();
 
+  // textures belong to the renderer, free them first
+  boardViews.clear();
+  pieces.destroy();
+
   SDL_DestroyRenderer(renderer);
   SDL_DestroyWindow(window);
   SDL_Quit();
 
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,517 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Attacks.h"
+#include "Board.h"
+#include "Evaluation.h"
+#include "PackedPosition.h"
+#include "Search.h"
+#include "ThreadPool.h"
+
+// Texel tuning of the evaluation weights: each dataset position is first played
+// down to a quiet one with a quiescence search, and the weights are then fitted
+// so that a sigmoid of the quiet position's evaluation predicts the game result.
+// The evaluation is linear in its weights, so a position's trace is enough to
+// get both its evaluation and its gradient for any set of weights.
+//
+// The dataset is streamed in batches every epoch rather than loaded, so its
+// size is only bound by the disk. One batch is parsed and resolved on the
+// thread pool while the next one is read. Packed datasets, as written by
+// --convert or chessgen, need no parsing and are used in place from a mapping.
+
+namespace {
+    constexpr int PieceValueCount = 7;
+    constexpr int PieceSquareCount = 7 * 64;
+    constexpr int MobilityCount = 7;
+    constexpr int KingDangerCount = 24;
+    constexpr int ParameterCount = PieceValueCount + PieceSquareCount + MobilityCount + KingDangerCount;
+
+    static_assert(sizeof(Evaluation::Trace) == ParameterCount * sizeof(int), "trace must be a flat array of counts");
+
+    constexpr int MateBound = 20000;
+    constexpr int MaxQuiescencePly = 64;
+
+    struct Term {
+        int16_t index;
+        int16_t count;
+    };
+
+    struct Options {
+        std::string datasetPath;
+        std::string outputPath = "EvalWeights.h";
+        int epochs = 20;
+        size_t batchSize = 16384;
+        double learningRate = 1.0;
+        // steepness of the result prediction, the usual Texel K
+        double k = 1.0;
+        int threads = 0;
+        // when set, the text dataset is written there as a packed file instead of tuned on
+        std::string convertPath;
+    };
+
+    // gradient and loss summed over one slice of a batch
+    struct Partial {
+        std::vector<double> gradient = std::vector<double>(ParameterCount);
+        double loss = 0;
+        uint64_t positions = 0;
+        uint64_t skipped = 0;
+    };
+
+    std::vector<double> initialWeights() {
+        std::vector<double> weights;
+        weights.reserve(ParameterCount);
+        weights.insert(weights.end(), std::begin(EvalWeights::PieceValues), std::end(EvalWeights::PieceValues));
+        for (const auto &table: EvalWeights::PieceSquare)
+            weights.insert(weights.end(), std::begin(table), std::end(table));
+        weights.insert(weights.end(), std::begin(EvalWeights::Mobility), std::end(EvalWeights::Mobility));
+        weights.insert(weights.end(), std::begin(EvalWeights::KingDanger), std::end(EvalWeights::KingDanger));
+        return weights;
+    }
+
+    bool isNumber(const std::string_view token) {
+        return !token.empty() && std::all_of(token.begin(), token.end(), [](const char c) { return c >= '0' && c <= '9'; });
+    }
+
+    // Accepts "FEN result" and EPD lines. The FEN may lack its move counters, and the
+    // result is taken from 1-0, 0-1, 1/2-1/2, a bracketed [1.0] style score or a trailing number.
+    bool parseLine(const std::string &line, std::string &fen, double &result) {
+        std::vector<std::string_view> tokens;
+        size_t position = 0;
+        while (tokens.size() < 6) {
+            position = line.find_first_not_of(" \t", position);
+            if (position == std::string::npos)
+                break;
+            const size_t end = std::min(line.find_first_of(" \t;", position), line.size());
+            tokens.emplace_back(line.data() + position, end - position);
+            position = end;
+        }
+        if (tokens.size() < 4 || (tokens[1] != "w" && tokens[1] != "b"))
+            return false;
+
+        size_t fields = 4;
+        fen.assign(tokens[0].begin(), tokens[3].end());
+        if (tokens.size() >= 6 && isNumber(tokens[4]) && isNumber(tokens[5])) {
+            fen.assign(tokens[0].begin(), tokens[5].end());
+            fields = 6;
+        } else {
+            fen += " 0 1";
+        }
+
+        // only look past the FEN, its dashes and counters could pass for a result
+        const std::string_view rest = std::string_view(line).substr(tokens[fields - 1].end() - line.data());
+        if (rest.find("1/2-1/2") != std::string_view::npos) {
+            result = 0.5;
+        } else if (rest.find("1-0") != std::string_view::npos) {
+            result = 1.0;
+        } else if (rest.find("0-1") != std::string_view::npos) {
+            result = 0.0;
+        } else {
+            const size_t start = rest.find_first_of("0123456789.");
+            if (start == std::string_view::npos)
+                return false;
+            result = std::strtod(std::string(rest.substr(start)).c_str(), nullptr);
+        }
+        return result >= 0 && result <= 1;
+    }
+
+    // Alpha-beta over captures, promotions and check evasions. `leaf` becomes the
+    // quiet position at the end of the principal variation.
+    int quiescence(const Board &board, const int ply, int alpha, const int beta, Board &leaf) {
+        AttackInfo info;
+        info.compute(board.getPosition());
+        leaf = board;
+
+        MoveList moves;
+        int bestScore;
+        if (info.checkers) {
+            board.generateMoves<GenType::EVASIONS>(moves, info);
+            if (moves.size == 0)
+                return -MATE_SCORE + ply;
+            bestScore = -MATE_SCORE;
+        } else {
+            bestScore = Evaluation::evaluate(board, info);
+            if (bestScore >= beta || ply >= MaxQuiescencePly)
+                return bestScore;
+            alpha = std::max(alpha, bestScore);
+
+            board.generateMoves<GenType::CAPTURES>(moves, info);
+        }
+
+        Board childLeaf;
+        for (const Move move: moves) {
+            if (!info.checkers && move.promotion() == PieceType::EMPTY && Attacks::see(board.getPosition(), move, info) < 0)
+                continue;
+
+            Board child = board;
+            child.makeMove(move);
+            const int score = -quiescence(child, ply + 1, -beta, -alpha, childLeaf);
+            if (score > bestScore) {
+                bestScore = score;
+                if (score > alpha) {
+                    alpha = score;
+                    leaf = childLeaf;
+                    if (score >= beta)
+                        break;
+                }
+            }
+        }
+        return bestScore;
+    }
+
+    // Resolves the position and accumulates its squared prediction error and gradient.
+    // Positions in check with no way out, or drifting into forced mates, carry no
+    // information about the evaluation and are skipped.
+    void accumulate(const Board &board, const double result, const std::vector<double> &weights, const double k,
+                    Partial &partial, std::vector<Term> &terms) {
+        Board leaf;
+        if (std::abs(quiescence(board, 0, -MATE_SCORE, MATE_SCORE, leaf)) >= MateBound) {
+            partial.skipped++;
+            return;
+        }
+
+        AttackInfo info;
+        info.compute(leaf.getPosition());
+        Evaluation::Trace trace;
+        Evaluation::evaluate(leaf, info, trace);
+
+        int counts[ParameterCount];
+        std::memcpy(counts, &trace, sizeof(counts));
+        terms.clear();
+        double eval = 0;
+        for (int i = 0; i < ParameterCount; i++) {
+            if (counts[i]) {
+                terms.push_back({static_cast<int16_t>(i), static_cast<int16_t>(counts[i])});
+                eval += weights[i] * counts[i];
+            }
+        }
+
+        // the predicted score for white is 1 / (1 + 10^(-k * eval / 400))
+        const double scale = k * std::log(10.0) / 400.0;
+        const double prediction = 1.0 / (1.0 + std::exp(-scale * eval));
+        const double error = prediction - result;
+        partial.loss += error * error;
+        partial.positions++;
+
+        const double slope = 2.0 * error * prediction * (1.0 - prediction) * scale;
+        for (const Term &term: terms)
+            partial.gradient[term.index] += slope * term.count;
+    }
+
+    void accumulate(const std::string &line, const std::vector<double> &weights, const double k, Partial &partial,
+                    std::string &fen, std::vector<Term> &terms) {
+        double result;
+        if (!parseLine(line, fen, result)) {
+            partial.skipped++;
+            return;
+        }
+        accumulate(Board(fen), result, weights, k, partial, terms);
+    }
+
+    void accumulate(const PackedRecord &record, const std::vector<double> &weights, const double k, Partial &partial,
+                    std::vector<Term> &terms) {
+        accumulate(Board(record.position.unpack()), record.result / 2.0, weights, k, partial, terms);
+    }
+
+    size_t readBatch(std::istream &stream, std::vector<std::string> &lines) {
+        size_t count = 0;
+        while (count < lines.size() && std::getline(stream, lines[count])) {
+            if (!lines[count].empty())
+                count++;
+        }
+        return count;
+    }
+
+    class Adam {
+    public:
+        explicit Adam(const double learningRate)
+            : mLearningRate(learningRate), mMoment(ParameterCount), mVelocity(ParameterCount) {}
+
+        void step(std::vector<double> &weights, const std::vector<double> &gradient) {
+            mSteps++;
+            const double correction1 = 1.0 - std::pow(Beta1, mSteps);
+            const double correction2 = 1.0 - std::pow(Beta2, mSteps);
+            for (int i = 0; i < ParameterCount; i++) {
+                mMoment[i] = Beta1 * mMoment[i] + (1 - Beta1) * gradient[i];
+                mVelocity[i] = Beta2 * mVelocity[i] + (1 - Beta2) * gradient[i] * gradient[i];
+                weights[i] -= mLearningRate * (mMoment[i] / correction1) / (std::sqrt(mVelocity[i] / correction2) + Epsilon);
+            }
+        }
+
+    private:
+        static constexpr double Beta1 = 0.9;
+        static constexpr double Beta2 = 0.999;
+        static constexpr double Epsilon = 1e-8;
+
+        double mLearningRate;
+        std::vector<double> mMoment;
+        std::vector<double> mVelocity;
+        int mSteps = 0;
+    };
+
+    struct EpochResult {
+        double loss = 0;
+        uint64_t positions = 0;
+        uint64_t skipped = 0;
+    };
+
+    // One pass over the dataset with an optimiser step per batch. A packed dataset
+    // is used straight from its mapping, a text one is read a batch ahead.
+    EpochResult runEpoch(const Options &options, const PackedFile *packed, ThreadPool &pool,
+                         std::vector<double> &weights, Adam &adam) {
+        EpochResult epoch;
+        std::ifstream stream;
+        if (!packed)
+            stream.open(options.datasetPath);
+
+        const int slices = pool.size();
+        std::vector<Partial> partials(slices);
+        std::vector<std::string> current, next;
+        if (!packed) {
+            current.resize(options.batchSize);
+            next.resize(options.batchSize);
+        }
+        std::vector<double> gradient(ParameterCount);
+
+        size_t read = 0;
+        const auto readNext = [&](std::vector<std::string> &lines) {
+            const size_t count = packed ? std::min(options.batchSize, packed->size() - read)
+                                        : readBatch(stream, lines);
+            read += count;
+            return count;
+        };
+
+        size_t count = readNext(current);
+        while (count > 0) {
+            const size_t first = read - count;
+            for (int s = 0; s < slices; s++) {
+                pool.submit([&, s, count, first] {
+                    Partial &partial = partials[s];
+                    std::fill(partial.gradient.begin(), partial.gradient.end(), 0.0);
+                    partial.loss = 0;
+                    partial.positions = partial.skipped = 0;
+
+                    std::string fen;
+                    std::vector<Term> terms;
+                    for (size_t i = s; i < count; i += slices) {
+                        if (packed)
+                            accumulate((*packed)[first + i], weights, options.k, partial, terms);
+                        else
+                            accumulate(current[i], weights, options.k, partial, fen, terms);
+                    }
+                });
+            }
+            const size_t nextCount = readNext(next);
+            pool.wait();
+
+            std::fill(gradient.begin(), gradient.end(), 0.0);
+            uint64_t positions = 0;
+            for (const Partial &partial: partials) {
+                for (int i = 0; i < ParameterCount; i++)
+                    gradient[i] += partial.gradient[i];
+                epoch.loss += partial.loss;
+                positions += partial.positions;
+                epoch.skipped += partial.skipped;
+            }
+            if (positions > 0) {
+                for (double &value: gradient)
+                    value /= static_cast<double>(positions);
+                adam.step(weights, gradient);
+            }
+            epoch.positions += positions;
+
+            std::swap(current, next);
+            count = nextCount;
+        }
+
+        if (epoch.positions > 0)
+            epoch.loss /= static_cast<double>(epoch.positions);
+        return epoch;
+    }
+
+    // Packs every usable line of a text dataset. Text datasets carry no scores and
+    // no game boundaries, so those fields are left at zero.
+    int convertDataset(const Options &options) {
+        std::ifstream in(options.datasetPath);
+        PackedWriter writer;
+        if (!writer.open(options.convertPath, false)) {
+            std::cout << writer.error() << std::endl;
+            return 1;
+        }
+
+        std::vector<PackedRecord> records;
+        records.reserve(options.batchSize);
+        std::string line, fen;
+        uint64_t skipped = 0;
+        while (std::getline(in, line)) {
+            double result;
+            if (line.empty())
+                continue;
+            if (!parseLine(line, fen, result)) {
+                skipped++;
+                continue;
+            }
+            records.push_back({PackedPosition::pack(Board(fen).getPosition()), 0,
+                               static_cast<uint8_t>(std::lround(result * 2)), 0, 0});
+            if (records.size() == options.batchSize) {
+                if (!writer.write(records.data(), records.size()))
+                    break;
+                records.clear();
+            }
+        }
+        if (!writer.write(records.data(), records.size()) || !writer.flush()) {
+            std::cout << writer.error() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Packed " << writer.size() << " positions into " << options.convertPath << ", skipped "
+                  << skipped << std::endl;
+        return 0;
+    }
+
+    void writeRow(std::ostream &out, const int *values, const int count) {
+        for (int i = 0; i < count; i++)
+            out << (i ? ", " : "") << values[i];
+    }
+
+    // writes the weights in the layout of chess-bot/EvalWeights.h
+    void writeHeader(std::ostream &out, const std::vector<double> &weights, const std::string &source) {
+        std::vector<int> rounded(weights.size());
+        std::transform(weights.begin(), weights.end(), rounded.begin(),
+                       [](const double weight) { return static_cast<int>(std::lround(weight)); });
+        const int *pieceValues = rounded.data();
+        const int *pieceSquare = pieceValues + PieceValueCount;
+        const int *mobility = pieceSquare + PieceSquareCount;
+        const int *kingDanger = mobility + MobilityCount;
+
+        constexpr const char *PieceNames[7] = {"empty", "pawn", "knight", "bishop", "rook", "queen", "king"};
+
+        out << "#ifndef CHESS_COMPETITION_EVAL_WEIGHTS_H\n";
+        out << "#define CHESS_COMPETITION_EVAL_WEIGHTS_H\n\n";
+        out << "// Evaluation weights in centipawns. Generated by chesstune, rerun it rather than editing by hand.\n";
+        out << "// Source: " << source << "\n";
+        out << "namespace EvalWeights {\n";
+        out << "    // indexed by PieceType\n";
+        out << "    constexpr int PieceValues[7] = {";
+        writeRow(out, pieceValues, PieceValueCount);
+        out << "};\n\n";
+        out << "    // indexed by [PieceType][square], from white's point of view with rank 8 on top\n";
+        out << "    constexpr int PieceSquare[7][64] = {\n";
+        for (int type = 0; type < 7; type++) {
+            out << "        { // " << PieceNames[type] << "\n";
+            for (int rank = 0; rank < 8; rank++) {
+                out << "        ";
+                for (int file = 0; file < 8; file++)
+                    out << std::setw(4) << pieceSquare[type * 64 + rank * 8 + file] << ",";
+                out << "\n";
+            }
+            out << "        },\n";
+        }
+        out << "    };\n\n";
+        out << "    // per safe square reachable, indexed by PieceType\n";
+        out << "    constexpr int Mobility[7] = {";
+        writeRow(out, mobility, MobilityCount);
+        out << "};\n\n";
+        out << "    // subtracted for the summed weight of the pieces attacking the king zone\n";
+        out << "    constexpr int KingDanger[24] = {\n        ";
+        writeRow(out, kingDanger, KingDangerCount);
+        out << "\n    };\n";
+        out << "} // namespace EvalWeights\n\n";
+        out << "#endif //CHESS_COMPETITION_EVAL_WEIGHTS_H\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--epochs") && i + 1 < argc) {
+            options.epochs = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--batch") && i + 1 < argc) {
+            options.batchSize = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else if (!std::strcmp(argv[i], "--lr") && i + 1 < argc) {
+            options.learningRate = std::stod(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--k") && i + 1 < argc) {
+            options.k = std::stod(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = std::stoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--output") && i + 1 < argc) {
+            options.outputPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--convert") && i + 1 < argc) {
+            options.convertPath = argv[++i];
+        } else if (argv[i][0] != '-' && options.datasetPath.empty()) {
+            options.datasetPath = argv[i];
+        } else {
+            std::cout << "usage: chesstune DATASET [--epochs N] [--batch N] [--lr RATE] [--k K] [--threads N] "
+                         "[--output FILE] [--convert PACKED]" << std::endl;
+            return 1;
+        }
+    }
+
+    // zero epochs just rewrites the current weights, which needs no dataset
+    if (options.datasetPath.empty() && options.epochs > 0) {
+        std::cout << "usage: chesstune DATASET [--epochs N] [--batch N] [--lr RATE] [--k K] [--threads N] "
+                     "[--output FILE] [--convert PACKED]" << std::endl;
+        return 1;
+    }
+    if (options.epochs > 0 && !std::ifstream(options.datasetPath)) {
+        std::cout << "cannot open " << options.datasetPath << std::endl;
+        return 1;
+    }
+
+    if (!options.convertPath.empty())
+        return convertDataset(options);
+
+    // packed datasets are mapped once and read in place every epoch
+    PackedFile packed;
+    const bool isPacked = options.epochs > 0 && PackedFile::isPackedFile(options.datasetPath);
+    if (isPacked && !packed.open(options.datasetPath)) {
+        std::cout << packed.error() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(options.threads);
+    Adam adam(options.learningRate);
+    std::vector<double> weights = initialWeights();
+
+    std::cout << "Parameters      : " << ParameterCount << "\n";
+    std::cout << "Threads         : " << pool.size() << std::endl;
+
+    EpochResult last;
+    for (int epoch = 1; epoch <= options.epochs; epoch++) {
+        const auto start = std::chrono::steady_clock::now();
+        last = runEpoch(options, isPacked ? &packed : nullptr, pool, weights, adam);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "epoch " << epoch << "/" << options.epochs << " loss " << std::setprecision(6) << last.loss
+                  << " positions " << last.positions << " skipped " << last.skipped << " time "
+                  << std::setprecision(3) << elapsed.count() << "s positions/s "
+                  << static_cast<uint64_t>(static_cast<double>(last.positions + last.skipped) / elapsed.count())
+                  << std::endl;
+    }
+
+    std::ostringstream source;
+    if (options.epochs > 0) {
+        source << options.datasetPath << ", " << last.positions << " positions, " << options.epochs
+               << " epochs, loss " << std::setprecision(6) << last.loss;
+    } else {
+        source << "compiled-in weights, not tuned";
+    }
+
+    std::ofstream out(options.outputPath);
+    if (!out) {
+        std::cout << "cannot write " << options.outputPath << std::endl;
+        return 1;
+    }
+    writeHeader(out, weights, source.str());
+    std::cout << "Weights written to " << options.outputPath << std::endl;
+    return 0;
+}